@@ -10,6 +10,12 @@
 #include "X6api.h"
 #include <iostream>
 #include <fstream>
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <thread>
+#include <random>
+#include <stdexcept>
 #include <Malibu_Mb.h>
 #include <IppMemoryUtils_Mb.h>
 #include <SystemSupport_Mb.h>
@@ -33,7 +39,37 @@ X6api::X6api()
     Init::UsePerformanceMemoryFunctions();
     //
     Timer.Interval(1000);
+	FCapture = 0;
+	FCaptureSize = 0;
+	FCaptureCapacity = 0;
+	FCaptureChannels = 1;
+	FCaptureSamples = 0;
 	ParaInit();
+	TrigTrain.OnEdge([this](bool state, TriggerScheduler::Clock::time_point deadline)
+		{
+			TrigLog.Push(state ? TriggerLog::esManualHigh : TriggerLog::esManualLow, deadline);
+			try
+			{
+				Trig.SetActiveTrigger(state);
+			}
+			catch (Innovative::MalibuException & exception)
+			{
+				throw std::runtime_error(exception.what());
+			}
+		});
+	Replays.OnSend([this](const ReplayQueue::Command & cmd) {  SendReplay(cmd);  });
+	//  The module is not thread safe: a sample is skipped while a driver call
+	//  or an async pattern load is using it
+	Health.OnSample([this](HealthMonitor::Sample & sample)
+		{
+			std::unique_lock<std::recursive_mutex> lock(FCallLock, std::try_to_lock);
+			if (!lock.owns_lock() || !FOpened || pattern_load_pending())
+				return false;
+			sample.Temperature = Temperature();
+			sample.PllLocked = PllLocked();
+			sample.DacCalOk = DacInternalCal();
+			return true;
+		});
 }
 
 //---------------------------------------------------------------------------
@@ -51,7 +87,25 @@ void X6api::ParaInit()
 {
 	FOpened = false;
 	FStreamConnected = false;
+	FPreconfigured = false;
+	FStreamPreconfigured = false;
+	FAppliedHash = 0;
+	FWarmTokenBase = 0;
+	FWarmTokenOffset = 0;
+	FWarmToken = 0;
+	FAdcRateActual = 0.;
+	FDacRateActual = 0.;
+	FPllLockTime = 0.;
 	Stopped = true;
+	FSequenceSteps.clear();
+	FPatternRegion = 0;
+	FLoadProgress = 0.;
+	FLoadCancel = false;
+	FLoadUploaded = false;
+	FLoadJoining = false;
+	FLoadRegion = 0;
+	FLoadAddr = 0;
+	FLoadSize = 0;
 
 	Settings.Target = 0;
 	const int   kDefHbuSige = 32;
@@ -72,6 +126,9 @@ void X6api::ParaInit()
 	Settings.Tx.FrameSize = 0x10000;
 	Settings.ExtTriggerSrcSelection = 0; // 0 for front panel
 	Settings.Tx.TriggerDelayPeriod = 1;
+	Settings.TriggerPeriod = 1000.0; // manual trigger train period, unit us
+	Settings.PllLockTimeout = 500.0; // unit ms
+	Settings.TriggerAlerts = false;
 	//  ..Analog
 	Settings.Tx.ActiveChannels[0] = 1;
 	Settings.Tx.ActiveChannels[1] = 1;
@@ -83,10 +140,16 @@ void X6api::ParaInit()
 	Settings.Tx.Pattern.LoopMode = false;
 	Settings.Tx.Pattern.Addr = 0x0;
 	Settings.Tx.Pattern.RepCount = 1;
+	Settings.Tx.Pattern.PingPong = false;
+	Settings.Tx.Pattern.PongAddr = 0x0;
 
 	//  ..Streaming
 	Settings.Tx.PacketSize = 0x100000;
 	Settings.Tx.AutoPreconfig = true;
+	Settings.Tx.ClipPolicy = cpSaturate;
+	Settings.Tx.AutoScale = asNone;
+	Settings.Tx.UploadChunkSize = 0x100000;
+	Settings.Tx.UploadInFlight = 2;
 
 	// Rx
 	Settings.Rx.ExternalTrigger = 0;
@@ -104,6 +167,15 @@ void X6api::ParaInit()
 	Settings.Rx.ForceSize = true;
 	Settings.Rx.TestCounterEnable = false;
 	Settings.Rx.TestGenMode = 0;
+
+	//  ..Calibration, nominal until ReadRom() or set_DacCalibration()
+	Settings.Rx.Gain.assign(InputChannels(), 1.0f);
+	Settings.Rx.Offset.assign(InputChannels(), 0.0f);
+	Settings.Rx.Calibrated = false;
+	Settings.Tx.Gain.assign(OutputChannels(), 1.0f);
+	Settings.Tx.Offset.assign(OutputChannels(), 0.0f);
+	Settings.Tx.IqSkew.assign(OutputChannels() / 2, 0.0f);
+	Settings.Tx.Calibrated = false;
 }
 void X6api::set_ReferenceClockSource(int ref_clk_s)
 {
@@ -118,6 +190,10 @@ void X6api::set_ExternalTrigger(int ext_trig)
 	Settings.Rx.ExternalTrigger = ext_trig;
 	Settings.Tx.ExternalTrigger = ext_trig;
 }
+void X6api::set_TriggerPeriod(double period)
+{
+	Settings.TriggerPeriod = period;
+}
 void X6api::set_AdcRate(double rate)
 {
 	Settings.Rx.SampleRate = rate;
@@ -166,6 +242,198 @@ void X6api::set_DacActiveChannel(vector<int> active_channels)
 	Settings.Tx.ActiveChannels[2] = active_channels[2];
 	Settings.Tx.ActiveChannels[3] = active_channels[3];
 }
+void X6api::set_DacCalibration(int channel, double gain, double offset)
+{
+	if (channel < 0 || channel >= static_cast<int>(OutputChannels()))
+	{
+		cout << "Error: no DAC channel " << channel << " \n";
+		return;
+	}
+	Settings.Tx.Gain[channel] = static_cast<float>(gain);
+	Settings.Tx.Offset[channel] = static_cast<float>(offset);
+	Settings.Tx.Calibrated = true;
+}
+void X6api::set_DacIqSkew(int device, double skew)
+{
+	if (device < 0 || device >= static_cast<int>(OutputChannels() / 2))
+	{
+		cout << "Error: no DAC device " << device << " \n";
+		return;
+	}
+	Settings.Tx.IqSkew[device] = static_cast<float>(skew);
+}
+void X6api::set_DacCalibrated(bool enable)
+{
+	Settings.Tx.Calibrated = enable;
+}
+void X6api::set_DacClipPolicy(int policy)
+{
+	Settings.Tx.ClipPolicy = policy;
+}
+void X6api::set_DacAutoScale(int mode)
+{
+	Settings.Tx.AutoScale = mode;
+}
+void X6api::set_DacUploadChunking(int chunk_words, int in_flight)
+{
+	Settings.Tx.UploadChunkSize = chunk_words > 0 ? chunk_words : 0;
+	Settings.Tx.UploadInFlight = in_flight > 0 ? in_flight : 1;
+}
+void X6api::set_PllLockTimeout(double timeout_ms)
+{
+	Settings.PllLockTimeout = timeout_ms > 0. ? timeout_ms : 0.;
+}
+void X6api::set_TriggerAlerts(bool enable)
+{
+	Settings.TriggerAlerts = enable;
+}
+void X6api::set_PatternPingPong(bool enable, unsigned int pong_addr)
+{
+	if (enable && pong_addr == Settings.Tx.Pattern.Addr)
+	{
+		cout << "Error: ping-pong regions must not share an address \n";
+		return;
+	}
+	Settings.Tx.Pattern.PingPong = enable;
+	Settings.Tx.Pattern.PongAddr = pong_addr;
+}
+
+//---------------------------------------------------------------------------
+//  SettingsFields() --  configuration fields held in a settings profile
+//---------------------------------------------------------------------------
+//  Target, module names, the loaded pattern database and the per-load pattern
+//  fields stay out, and so does the ROM calibration (gain, offset, IQ skew),
+//  which belongs to the board the profile is loaded on. Bump kSettingsVersion
+//  whenever this list changes.
+static const uint32_t kSettingsVersion = 3;
+
+template <class Archive, class Settings>
+static void SettingsFields(Archive & ar, Settings & s)
+{
+	ar(s.ExtClockSrcSelection);
+	ar(s.ReferenceClockSource);
+	ar(s.ReferenceRate);
+	ar(s.SampleClockSource);
+	ar(s.ExtTriggerSrcSelection);
+	ar(s.TriggerPeriod);
+	ar(s.PllLockTimeout);
+	ar(s.TriggerAlerts);
+	//  ..Rx
+	ar(s.Rx.BusmasterSize);
+	ar(s.Rx.SampleRate);
+	ar(s.Rx.ExternalTrigger);
+	ar(s.Rx.EdgeTrigger);
+	ar(s.Rx.Framed);
+	ar(s.Rx.FrameSize);
+	ar(s.Rx.repeats);
+	ar(s.Rx.TriggerDelayPeriod);
+	ar(s.Rx.ActiveChannels);
+	ar(s.Rx.DecimationEnable);
+	ar(s.Rx.DecimationFactor);
+	ar(s.Rx.PacketSize);
+	ar(s.Rx.ForceSize);
+	ar(s.Rx.TestCounterEnable);
+	ar(s.Rx.TestGenMode);
+	//  ..Tx
+	ar(s.Tx.BusmasterSize);
+	ar(s.Tx.SampleRate);
+	ar(s.Tx.ExternalTrigger);
+	ar(s.Tx.EdgeTrigger);
+	ar(s.Tx.Framed);
+	ar(s.Tx.FrameSize);
+	ar(s.Tx.TriggerDelayPeriod);
+	ar(s.Tx.ActiveChannels);
+	ar(s.Tx.DecimationEnable);
+	ar(s.Tx.DecimationFactor);
+	ar(s.Tx.PacketSize);
+	ar(s.Tx.AutoPreconfig);
+	ar(s.Tx.ClipPolicy);
+	ar(s.Tx.AutoScale);
+	ar(s.Tx.UploadChunkSize);
+	ar(s.Tx.UploadInFlight);
+	ar(s.Tx.Pattern.Addr);
+	ar(s.Tx.Pattern.RepCount);
+	ar(s.Tx.Pattern.LoopMode);
+	ar(s.Tx.Pattern.PingPong);
+	ar(s.Tx.Pattern.PongAddr);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::save_settings() --  write Settings as a binary profile
+//---------------------------------------------------------------------------
+bool X6api::save_settings(const std::string & path)
+{
+	Innovative::SettingsWriter writer;
+	SettingsFields(writer, Settings);
+	if (!writer.Save(path, kSettingsVersion))
+	{
+		cout << "Error: cannot write settings profile " << path << " \n";
+		return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::load_settings() --  replace Settings with a verified profile
+//---------------------------------------------------------------------------
+//  Settings are left alone unless the whole profile reads back. Loading the
+//  profile already applied leaves the next StreamPreconfigure() nothing to do.
+bool X6api::load_settings(const std::string & path)
+{
+	Innovative::SettingsReader reader;
+	std::string error;
+	if (!reader.Load(path, kSettingsVersion, error))
+	{
+		cout << "Error: " << error << " \n";
+		return false;
+	}
+	ApplicationSettings loaded = Settings;
+	SettingsFields(reader, loaded);
+	if (!reader.Complete())
+	{
+		cout << "Error: settings profile " << path << " does not match this driver \n";
+		return false;
+	}
+	Settings = loaded;
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::settings_hash() --  content hash of Settings, as saved in a profile
+//---------------------------------------------------------------------------
+uint64_t X6api::settings_hash() const
+{
+	Innovative::SettingsWriter writer;
+	SettingsFields(writer, Settings);
+	return writer.Hash();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::AppliedHash() --  hash of the fields StreamPreconfigure() programs
+//---------------------------------------------------------------------------
+//  Software-only settings (trigger period, upload chunking, clip policy...)
+//  stay out, so changing them does not make the hardware look stale.
+uint64_t X6api::AppliedHash(const ApplicationSettings & s) const
+{
+	Innovative::SettingsWriter writer;
+	writer(s.Tx.ActiveChannels);
+	writer(s.Rx.ActiveChannels);
+	writer(s.ExtClockSrcSelection);
+	writer(s.ReferenceClockSource);
+	writer(s.ReferenceRate);
+	writer(s.SampleClockSource);
+	writer(s.Rx.SampleRate);
+	writer(s.Tx.SampleRate);
+	return writer.Hash();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::settings_applied() --  hardware already runs Settings
+//---------------------------------------------------------------------------
+bool X6api::settings_applied() const
+{
+	return FPreconfigured && AppliedHash(Settings) == FAppliedHash;
+}
 
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -203,8 +471,43 @@ string X6api::PrintDevices()
 //---------------------------------------------------------------------------
 void X6api::Open(int target)
 {
+	OpenBoard(target, std::string(), 0, 0);
+}
+
+//---------------------------------------------------------------------------
+// X6api::open_warm() --  open with a profile, attaching without reset if it runs
+//---------------------------------------------------------------------------
+//  Returns true when the board was attached warm. Otherwise the board is reset
+//  as by Open() and the profile is applied at the next StreamPreconfigure().
+//  Each configuration applied from here writes a fresh token to the scratch
+//  register and saves it beside the profile; a reset or power cycle clears the
+//  register, so a stale state file can no longer match the board.
+//  A warm attach skips Module.Reset() only. The stream object is new in this
+//  process and is built by Stream.Preconfigure(), which also pushes the module
+//  settings to the hardware, so the first StreamPreconfigure() runs it, waits
+//  for the PLLs and saves a new state and token as after a cold open.
+bool X6api::open_warm(int target, const std::string & profile,
+	uint32_t token_base, uint32_t token_offset)
+{
+	return OpenBoard(target, profile, token_base, token_offset);
+}
+
+//---------------------------------------------------------------------------
+// X6api::OpenBoard() --  Open() and open_warm(), true if attached warm
+//---------------------------------------------------------------------------
+bool X6api::OpenBoard(int target, const std::string & profile,
+	uint32_t token_base, uint32_t token_offset)
+{
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+	//  The sampler must not see the module while it is reopened and reset
+	Health.Stop();
 	ParaInit();
 	Settings.Target = target;
+	FWarmProfile = profile;
+	FWarmTokenBase = token_base;
+	FWarmTokenOffset = token_offset;
+	if (!profile.empty() && !load_settings(profile))
+		FWarmProfile.clear();
 	//  Configure Trigger Manager Event Handlers
     Trig.OnDisableTrigger.SetEvent(this, &X6api::HandleDisableTrigger);
     Trig.OnExternalTrigger.SetEvent(this, &X6api::HandleExternalTrigger);
@@ -258,21 +561,151 @@ void X6api::Open(int target)
         {
         cout << "Open Failure \n";
 		cout << exception.what() << "\n";
-        return;
+        return false;
         }
     catch(...)
         {
         cout << "Module Device Open Failure! \n";
-        return;
+        return false;
         }
+    {
+        std::lock_guard<std::mutex> lock(FWishboneLock);
+        FWishboneSpaces.clear();
+        FLogicMemory.reset(new Innovative::LogicMemorySpace(Module));
+    }
         
-    Module.Reset();
+    ReadBoardInfo();
+    const bool warm = !FWarmProfile.empty() && BoardStateMatches();
+    if (!warm)
+        Module.Reset();
+    {
+        std::lock_guard<std::mutex> lock(FWishboneLock);
+        FShadow.Invalidate();
+    }
+    // the saved state is stale until the next StreamPreconfigure()
+    if (!warm && !FWarmProfile.empty())
+        InvalidateBoardState();
     FOpened = true;
     //
     //  Connect Stream
     Stream.ConnectTo(&Module);
     FStreamConnected = true;
     PrefillPacketCount = Stream.PrefillPacketCount();
+    if (warm)
+        {
+        //  The hardware already runs the profile; only the module object learns it.
+        //  Stream.Preconfigure() still runs once at the first StreamPreconfigure(),
+        //  so the stream's software state is built as after a cold open.
+        ConfigureModule(true, true, true, true, true);
+        FApplied = Settings;
+        FAppliedHash = AppliedHash(Settings);
+        FPreconfigured = true;
+        }
+    return warm;
+}
+
+//---------------------------------------------------------------------------
+// X6api::BoardStatePath() --  state saved beside the warm-open profile
+//---------------------------------------------------------------------------
+std::string X6api::BoardStatePath() const
+{
+    return FWarmProfile + ".state";
+}
+
+//---------------------------------------------------------------------------
+// X6api::FirmwareId() --  logic version and bitstream build time
+//---------------------------------------------------------------------------
+std::string X6api::FirmwareId()
+{
+    return FpgaLogicVersion() + " " + BitStreamDate() + " " + BitStreamTime();
+}
+
+//---------------------------------------------------------------------------
+// X6api::SaveBoardState() --  record what the board runs, for open_warm()
+//---------------------------------------------------------------------------
+//  Target, applied settings hash, firmware and a new board token, in the
+//  settings profile format. The token goes to the board only once the file is
+//  written, so the two can only match when both are current.
+static const uint32_t kBoardStateVersion = 3;
+
+void X6api::SaveBoardState()
+{
+    std::random_device random;
+    uint32_t token = 0;
+    while (!token)
+        token = random();
+
+    Innovative::SettingsWriter writer;
+    writer(Settings.Target);
+    writer(FAppliedHash);
+    writer(FirmwareId());
+    writer(token);
+    if (!writer.Save(BoardStatePath(), kBoardStateVersion))
+        {
+        cout << "Error: cannot write board state " << BoardStatePath() << " \n";
+        return;
+        }
+    WriteWarmToken(token);
+}
+
+//---------------------------------------------------------------------------
+// X6api::InvalidateBoardState() --  board no longer proven to run the state file
+//---------------------------------------------------------------------------
+void X6api::InvalidateBoardState()
+{
+    WriteWarmToken(0);
+    std::remove(BoardStatePath().c_str());
+}
+
+//---------------------------------------------------------------------------
+// X6api::WriteWarmToken() --  scratch register, always written to the bus
+//---------------------------------------------------------------------------
+void X6api::WriteWarmToken(uint32_t token)
+{
+    std::lock_guard<std::mutex> lock(FWishboneLock);
+    FShadow.Write(FWarmTokenBase, FWarmTokenOffset, token);
+    Innovative::Register reg = Register(WishboneSpace(FWarmTokenBase), FWarmTokenOffset);
+    reg.Value(token);
+    FWarmToken = token;
+}
+
+//---------------------------------------------------------------------------
+// X6api::ReadWarmToken() --  scratch register as the board holds it
+//---------------------------------------------------------------------------
+uint32_t X6api::ReadWarmToken()
+{
+    std::lock_guard<std::mutex> lock(FWishboneLock);
+    Innovative::Register reg = Register(WishboneSpace(FWarmTokenBase), FWarmTokenOffset);
+    return reg.Value();
+}
+
+//---------------------------------------------------------------------------
+// X6api::BoardStateMatches() --  board still runs the loaded profile
+//---------------------------------------------------------------------------
+//  The saved state must name this target, the profile's applied hash, the firmware
+//  read back now, its token must still be in the board's scratch register, and
+//  the PLL must still be locked.
+bool X6api::BoardStateMatches()
+{
+    Innovative::SettingsReader reader;
+    std::string error;
+    if (!reader.Load(BoardStatePath(), kBoardStateVersion, error))
+        return false;
+    int target = -1;
+    uint64_t hash = 0;
+    std::string firmware;
+    uint32_t token = 0;
+    reader(target);
+    reader(hash);
+    reader(firmware);
+    reader(token);
+    if (!reader.Complete() || !token || token != ReadWarmToken())
+        return false;
+    FWarmToken = token;
+    return target == Settings.Target
+        && hash == AppliedHash(Settings)
+        && firmware == FirmwareId()
+        && Module.Clock().Locked();
 }
 
 //---------------------------------------------------------------------------
@@ -280,61 +713,178 @@ void X6api::Open(int target)
 //---------------------------------------------------------------------------
 void X6api::Close()
 {
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+    FLoadCancel = true;
+    WaitPatternLoad();
+    TrigTrain.Stop();
+    Replays.Stop();
+    Health.Stop();
     Stream.Disconnect();
+    {
+        std::lock_guard<std::mutex> lock(FWishboneLock);
+        FWishboneSpaces.clear();
+        FLogicMemory.reset();
+        FShadow.Invalidate();
+    }
     Module.Close();
     FStreamConnected = false;
+    FPreconfigured = false;
+    FStreamPreconfigured = false;
+    FBoardInfo = BoardInfo();
     FOpened = false;
 	//
-	adc_data_.clear();
-	adc_data_.swap(vector<int>());
+	ReleaseCapture();
 	//
 }
 
 //---------------------------------------------------------------------------
 // X6api::StreamPreconfigure()
 //---------------------------------------------------------------------------
-void X6api::StreamPreconfigure()
+//  Returns false when the PLLs did not lock; the settings are then not
+//  recorded as applied, so the next call programs them again.
+bool X6api::StreamPreconfigure()
 {
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
 	// update Rx.PacketSize
 	Settings.Rx.PacketSize = (Settings.Rx.FrameSize + 16)*Settings.Rx.repeats * 2;
+	//
+	//  Only settings that differ from the last applied ones touch the hardware,
+	//  so repeated starts with the same settings skip the PLL relock
+	const ApplicationSettings & last = FApplied;
+	const bool all = !FPreconfigured;
+	const bool tx_channels = all || Settings.Tx.ActiveChannels != last.Tx.ActiveChannels;
+	const bool rx_channels = all || Settings.Rx.ActiveChannels != last.Rx.ActiveChannels;
+	const bool routing = all
+		|| Settings.ExtClockSrcSelection != last.ExtClockSrcSelection
+		|| Settings.ReferenceClockSource != last.ReferenceClockSource
+		|| Settings.ReferenceRate != last.ReferenceRate
+		|| Settings.SampleClockSource != last.SampleClockSource;
+	// a new reference or source relocks both PLLs
+	const bool adc_clock = routing || Settings.Rx.SampleRate != last.Rx.SampleRate;
+	const bool dac_clock = routing || Settings.Tx.SampleRate != last.Tx.SampleRate;
+	// once per process, also after a warm open, for the stream's own state
+	const bool stream = !FStreamPreconfigured;
+	if (!(tx_channels || rx_channels || adc_clock || dac_clock || stream))
+		return true;
+
+    //  Until the new state is saved, a warm open must not trust the old one
+    if (!FWarmProfile.empty() && FWarmToken)
+        InvalidateBoardState();
+    //  The relock starts with the clock programming and mostly happens inside
+    //  Stream.Preconfigure(), so both count towards pll_lock_time()
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    ConfigureModule(tx_channels, rx_channels, routing, adc_clock, dac_clock);
+    Stream.Preconfigure();
+    FStreamPreconfigured = true;
+    if ((adc_clock || dac_clock || stream) && !WaitPllLock(start))
+        {
+        cout << "Error: PLL not locked after " << Settings.PllLockTimeout << " ms \n";
+        return false;
+        }
+    FApplied = Settings;
+    FAppliedHash = AppliedHash(Settings);
+    FPreconfigured = true;
+    if (!FWarmProfile.empty())
+        SaveBoardState();
+    return true;
+}
+
+//---------------------------------------------------------------------------
+// X6api::ConfigureModule() --  set the selected groups of module settings
+//---------------------------------------------------------------------------
+//  Takes effect in hardware at the next Stream.Preconfigure().
+void X6api::ConfigureModule(bool tx_channels, bool rx_channels, bool routing,
+    bool adc_clock, bool dac_clock)
+{
 	//  Set Channel Enables
-    Module.Output().ChannelDisableAll();
-    for (unsigned int i = 0; i < Module.Output().Channels(); ++i)
+    if (tx_channels)
         {
-        bool active = Settings.Tx.ActiveChannels[i] ? true : false;
-        if (active==true)
-            Module.Output().ChannelEnabled(i, true);
+        Module.Output().ChannelDisableAll();
+        for (unsigned int i = 0; i < Module.Output().Channels(); ++i)
+            {
+            bool active = Settings.Tx.ActiveChannels[i] ? true : false;
+            if (active==true)
+                Module.Output().ChannelEnabled(i, true);
+            }
         }
 
     //  Channel Enables
-    Module.Input().ChannelDisableAll();
-    for (unsigned int i = 0; i < Module.Input().Channels(); ++i)
+    if (rx_channels)
         {
-        bool active = Settings.Rx.ActiveChannels[i] ? true : false;
-        if (active==true)
-            Module.Input().ChannelEnabled(i, true);
+        Module.Input().ChannelDisableAll();
+        for (unsigned int i = 0; i < Module.Input().Channels(); ++i)
+            {
+            bool active = Settings.Rx.ActiveChannels[i] ? true : false;
+            if (active==true)
+                Module.Input().ChannelEnabled(i, true);
+            }
         }
 
     //
     // Clock Configuration
-    //   Route ext clock source
-    IX6ClockIo::IIClockSelect cks[] = { IX6ClockIo::cslFrontPanel, IX6ClockIo::cslP16 };
-    Module.Clock().ExternalClkSelect(cks[Settings.ExtClockSrcSelection]);
-    //   Route reference.
-    IX6ClockIo::IIReferenceSource ref[] = { IX6ClockIo::rsExternal, IX6ClockIo::rsInternal };
-    Module.Clock().Reference(ref[Settings.ReferenceClockSource]);
-    Module.Clock().ReferenceFrequency(Settings.ReferenceRate * 1e6);
-    //   Route clock
-    IX6ClockIo::IIClockSource src[] = { IX6ClockIo::csExternal, IX6ClockIo::csInternal };
-    Module.Clock().Source(src[Settings.SampleClockSource]);
-    Module.Clock().Adc().Frequency(Settings.Rx.SampleRate * 1e6);
-    Module.Clock().Dac().Frequency(Settings.Tx.SampleRate * 1e6);
-    // Readback Frequency
-    double adc_freq_actual = Module.Clock().Adc().FrequencyActual();
-    double dac_freq_actual = Module.Clock().Dac().FrequencyActual();
-    double adc_freq = Module.Clock().Adc().Frequency();
-    double dac_freq = Module.Clock().Dac().Frequency();
-    Stream.Preconfigure();
+    if (routing)
+        {
+        //   Route ext clock source
+        IX6ClockIo::IIClockSelect cks[] = { IX6ClockIo::cslFrontPanel, IX6ClockIo::cslP16 };
+        Module.Clock().ExternalClkSelect(cks[Settings.ExtClockSrcSelection]);
+        //   Route reference.
+        IX6ClockIo::IIReferenceSource ref[] = { IX6ClockIo::rsExternal, IX6ClockIo::rsInternal };
+        Module.Clock().Reference(ref[Settings.ReferenceClockSource]);
+        Module.Clock().ReferenceFrequency(Settings.ReferenceRate * 1e6);
+        //   Route clock
+        IX6ClockIo::IIClockSource src[] = { IX6ClockIo::csExternal, IX6ClockIo::csInternal };
+        Module.Clock().Source(src[Settings.SampleClockSource]);
+        }
+    //   Actual rates are cached per request, so sweeps revisiting a rate skip the readback
+    if (adc_clock)
+        {
+        Module.Clock().Adc().Frequency(Settings.Rx.SampleRate * 1e6);
+        ClockKey key(Settings.SampleClockSource, Settings.ReferenceClockSource,
+            Settings.ReferenceRate, Settings.Rx.SampleRate);
+        std::map<ClockKey, double>::iterator it = FAdcActual.find(key);
+        if (it == FAdcActual.end())
+            it = FAdcActual.insert(std::make_pair(key, Module.Clock().Adc().FrequencyActual() / 1e6)).first;
+        FAdcRateActual = it->second;
+        }
+    if (dac_clock)
+        {
+        Module.Clock().Dac().Frequency(Settings.Tx.SampleRate * 1e6);
+        ClockKey key(Settings.SampleClockSource, Settings.ReferenceClockSource,
+            Settings.ReferenceRate, Settings.Tx.SampleRate);
+        std::map<ClockKey, double>::iterator it = FDacActual.find(key);
+        if (it == FDacActual.end())
+            it = FDacActual.insert(std::make_pair(key, Module.Clock().Dac().FrequencyActual() / 1e6)).first;
+        FDacRateActual = it->second;
+        }
+}
+
+//---------------------------------------------------------------------------
+// X6api::WaitPllLock() --  poll for lock, recording the time since start
+//---------------------------------------------------------------------------
+//  Bounded by Settings.PllLockTimeout; FPllLockTime is -1 on timeout. Polls
+//  every millisecond, which is fine against relock times of tens of ms.
+bool X6api::WaitPllLock(std::chrono::steady_clock::time_point start)
+{
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point deadline = start +
+        std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double, std::milli>(Settings.PllLockTimeout));
+    for (;;)
+        {
+        bool locked = Module.Clock().Locked();
+        Clock::time_point now = Clock::now();
+        if (locked)
+            {
+            FPllLockTime = std::chrono::duration<double, std::milli>(now - start).count();
+            return true;
+            }
+        if (now >= deadline)
+            {
+            FPllLockTime = -1.;
+            return false;
+            }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -354,9 +904,10 @@ void X6api::StreamPreconfigure()
 //---------------------------------------------------------------------------
 bool X6api::StartStreaming()
 {
-    //  if auto-preconfiging, call preconfig here.
-    if (Settings.Tx.AutoPreconfig)
-        StreamPreconfigure();
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+    //  if auto-preconfiging, call preconfig here; never stream on unlocked clocks
+    if (Settings.Tx.AutoPreconfig && !StreamPreconfigure())
+        return false;
 
     if (!FStreamConnected)
         {
@@ -454,11 +1005,35 @@ bool X6api::StartStreaming()
     Module.Input().Decimation(factor);
 
 	//
-	adc_data_.clear();
-	adc_data_.swap(vector<int>());
+	ReleaseCapture();
+	{
+		std::lock_guard<std::mutex> lock(FCaptureLock);
+		FCaptureChannels = 0;
+		for (size_t i = 0; i < Settings.Rx.ActiveChannels.size(); i++)
+			if (Settings.Rx.ActiveChannels[i])
+				FCaptureChannels++;
+		FCaptureChannels = (std::max)(FCaptureChannels, size_t(1));
+		FCaptureSamples = Settings.Rx.FrameSize;
+	}
     //
 
     Stream.PrefillPacketCount(0);
+    WaitPatternLoad();
+    TrigLog.Reset();
+    PatternDone.Reset();
+    //  Every hooked alert is counted, so data-path faults are not lost. The
+    //  trigger alert fires once per trigger, so it is only on when asked for.
+    IX6Alerts::AlertType alerts[] = {
+        IX6Alerts::alertTimeStampRollover, IX6Alerts::alertSoftware,
+        IX6Alerts::alertWarningTemperature, IX6Alerts::alertInputOverflow,
+        IX6Alerts::alertOutputUnderflow,
+        IX6Alerts::alertInputOverrange, IX6Alerts::alertOutputOverrange,
+        IX6Alerts::alertPatternDone };
+    for (size_t i = 0; i < sizeof(alerts) / sizeof(alerts[0]); i++)
+        Module.Alerts().AlertEnable(alerts[i], true);
+    Module.Alerts().AlertEnable(IX6Alerts::alertTrigger, Settings.TriggerAlerts);
+    ProgramReplays();
+    Replays.Start();
     Trig.AtStreamStart();
     //  Start Streaming
     Stopped = false;
@@ -470,6 +1045,18 @@ bool X6api::StartStreaming()
 // X6api::StopStreaming()
 //---------------------------------------------------------------------------
 void X6api::StopStreaming()
+{
+    HaltStreaming();
+    //  Not a stream callback, so the replay worker can be joined here
+    Replays.Stop();
+}
+
+//---------------------------------------------------------------------------
+// X6api::HaltStreaming() --  stop, safe from stream callbacks
+//---------------------------------------------------------------------------
+//  The replay worker may be blocked sending on this stream, so it is only
+//  told to stop; StopStreaming(), StartStreaming() or Close() joins it.
+void X6api::HaltStreaming()
 {
     if (!IsStreaming())
         return;
@@ -486,11 +1073,16 @@ void X6api::StopStreaming()
     if (Settings.Rx.TestCounterEnable)
 		Module.Input().TestModeEnabled(false, Settings.Rx.TestGenMode);
     Trig.AtStreamStop();
+    Replays.Halt();
 }
 
 //---------------------------------------------------------------------------
 //  X6api::HandleDataAvailable() --  Handle received packet
 //---------------------------------------------------------------------------
+//  The Velo buffer holds one VITA packet per channel and trigger, the channels
+//  taking turns: 14 shorts of header, FrameSize samples, 2 shorts of trailer.
+//  Only the samples are kept, so packets appended in arrival order already
+//  lie as (repeats, channels, samples).
 void  X6api::HandleDataAvailable(VitaPacketStreamDataEvent & Event)
 {
 	if (Stopped)
@@ -499,13 +1091,42 @@ void  X6api::HandleDataAvailable(VitaPacketStreamDataEvent & Event)
     //  Extract the packet from the Incoming Queue...
     Event.Sender->Recv(Packet);
 	AccessDatagram<int short> ShortDG(Packet);
-	for (int idx = 0; idx < ShortDG.SizeInInts(); idx++)
+	const size_t header = 14, trailer = 2;
+	size_t size = ShortDG.SizeInInts();
+	size_t frames = 0;
+	bool stored = true;
 	{
-		adc_data_.push_back(ShortDG[idx]);
+		std::lock_guard<std::mutex> lock(FCaptureLock);
+		const size_t samples = FCaptureSamples;
+		const size_t stride = samples + header + trailer;
+		frames = samples ? size / stride : 0;
+		size_t count = frames * samples;
+		if (FCaptureSize + count > FCaptureCapacity)
+		{
+			size_t capacity = (std::max)(FCaptureSize + count, 2 * FCaptureCapacity);
+			short * grown = static_cast<short *>(std::realloc(FCapture, capacity * sizeof(short)));
+			if (grown)
+			{
+				FCapture = grown;
+				FCaptureCapacity = capacity;
+			}
+			else
+				stored = false;
+		}
+		for (size_t f = 0; stored && f < frames; f++)
+		{
+			size_t idx = f * stride + header;
+			for (size_t n = 0; n < samples; n++)
+				FCapture[FCaptureSize++] = ShortDG[idx + n];
+		}
 	}
+	if (!stored)
+		cout << "Error: out of memory for ADC capture \n";
+	else if (size != frames * (FCaptureSamples + header + trailer))
+		cout << "Error: ADC buffer of " << size << " shorts is not whole frames \n";
 	//  Stop streaming when both Channels have passed their limit
 	double elapsed = RunTimeSW.Stop();
-	StopStreaming();
+	HaltStreaming();
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -539,125 +1160,651 @@ void  X6api::LeavePatternMode()
 }
 
 //------------------------------------------------------------------------------
-//  X6api::PatternLoadCommand() --
+//  X6api::PatternStreamIds() -- Pack SIDs, Tags Arrays of enabled devices
 //------------------------------------------------------------------------------
-void  X6api::PatternLoadCommand()
+void  X6api::PatternStreamIds(std::vector<unsigned int> & sids, std::vector<char> & tags)
 {
-	//  Pack SIDs, Tags Arrays
-	std::vector<unsigned int> sids;
+	sids.clear();
+	tags.clear();
 	unsigned int sid_0 = Module.VitaOut().VitaStreamId(0);
 	unsigned int sid_1 = Module.VitaOut().VitaStreamId(1);
 	if (Module.Output().ChannelEnabled(0) || Module.Output().ChannelEnabled(1))
 		sids.push_back(sid_0);
 	if (Module.Output().ChannelEnabled(2) || Module.Output().ChannelEnabled(3))
 		sids.push_back(sid_1);
-	std::vector<char> tags;
 	for (unsigned int i = 0; i<sids.size(); i++)
 		tags.push_back(i);
-	//
+}
+
+//------------------------------------------------------------------------------
+//  X6api::LoadPattern() -- Load wavedata_ at addr, add to patterns database
+//------------------------------------------------------------------------------
+bool  X6api::LoadPattern(const std::string & label, unsigned int addr)
+{
+	//  Build first, so a rejected waveform leaves pattern memory untouched
+	if (!BuildWaveform())
+		return false;
+	SendPattern(label, addr, PatternSize());
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::SendPattern() -- Upload the built waveform, add to database
+//------------------------------------------------------------------------------
+void  X6api::SendPattern(const std::string & label, unsigned int addr, unsigned int size_in_words)
+{
 	//  Add to loaded patterns database
-	Settings.Tx.LoadedPatterns.clear();
-	Settings.Tx.Pattern.DB_Selection = 0;
-	unsigned int buffer_size_ints = PatternSize(); // whole wavedata length for 4 channels
-	TxSettings::PatternDBEntry entry("ArbWave", Settings.Tx.Pattern.Addr, buffer_size_ints);
+	TxSettings::PatternDBEntry entry(label, addr, size_in_words);
 	Settings.Tx.LoadedPatterns.push_back(entry);
+	PatternInfo info;
+	GetPatternInfo(info);
+	UploadPattern(addr, size_in_words, info);
+}
 
-	IPatternModeSystem::PatternRepeatType mode =
-		Settings.Tx.Pattern.LoopMode ?
+//------------------------------------------------------------------------------
+//  X6api::GetPatternInfo() -- Info packet fields from the current settings
+//------------------------------------------------------------------------------
+void  X6api::GetPatternInfo(PatternInfo & info)
+{
+	PatternStreamIds(info.Sids, info.Tags);
+	info.RepCount = Settings.Tx.Pattern.RepCount;
+	info.Mode = Settings.Tx.Pattern.LoopMode ?
 		IPatternModeSystem::prPlayAgain :
 		IPatternModeSystem::prFlatline;
-	//
-	//  Send the Info Packet
-	Module.Output().Pattern().SendPatternInfo(
-		0, // pid 
-		sids,
-		tags, //Settings.Tx.Pattern.Tag, 
-		Settings.Tx.Pattern.Addr,
-		buffer_size_ints,
-		Settings.Tx.Pattern.RepCount,
-		IPatternModeSystem::piLoad,
-		mode);
-	//  Send the Data Packet(s) - uses WaveformPacket
-	BufferTransmit();
 }
 
 //------------------------------------------------------------------------------
-//  X6api::PatternReplayCommand() --
+//  X6api::UploadPattern() -- Send the Info and Data Packets of the built waveform
 //------------------------------------------------------------------------------
-void  X6api::PatternReplayCommand()
+//  Reads info and the Builder only, so it may run on the async load worker.
+void  X6api::UploadPattern(unsigned int addr, unsigned int size_in_words, const PatternInfo & info)
 {
-	//  Find pattern information from the database
-	TxSettings::PatternDBEntry entry = Settings.Tx.LoadedPatterns[Settings.Tx.Pattern.DB_Selection];
-	IPatternModeSystem::PatternRepeatType mode =
-		Settings.Tx.Pattern.LoopMode ?
-		IPatternModeSystem::prPlayAgain :
-		IPatternModeSystem::prFlatline;
-	//  Pack SIDs, Tags Arrays
-	std::vector<unsigned int> sids;
-	unsigned int sid_0 = Module.VitaOut().VitaStreamId(0);
-	unsigned int sid_1 = Module.VitaOut().VitaStreamId(1);
-	if (Module.Output().ChannelEnabled(0) || Module.Output().ChannelEnabled(1))
-		sids.push_back(sid_0);
-	if (Module.Output().ChannelEnabled(2) || Module.Output().ChannelEnabled(3))
-		sids.push_back(sid_1);
-	std::vector<char> tags;
-	for (unsigned int i = 0; i<sids.size(); i++)
-		tags.push_back(i);
-	//
+	//  Replays triggered meanwhile wait until the last data chunk is sent
+	std::lock_guard<std::mutex> stream(FPatternStreamLock);
 	//  Send the Info Packet
 	Module.Output().Pattern().SendPatternInfo(
 		0, // pid 
-		sids,
-		tags, //Settings.Tx.Pattern.Tag, 
-		entry.Addr,
-		entry.SizeInWords,
-		Settings.Tx.Pattern.RepCount,
-		IPatternModeSystem::piReplay,
-		mode);
+		info.Sids,
+		info.Tags, //Settings.Tx.Pattern.Tag, 
+		addr,
+		size_in_words,
+		info.RepCount,
+		IPatternModeSystem::piLoad,
+		static_cast<IPatternModeSystem::PatternRepeatType>(info.Mode));
+	//  Send the Data Packet(s)
+	if (Module.Output().Pattern().PatternModeEnable())
+		UploadWaveform();
 }
 
-//---------------------------------------------------------------------------
-//  X6api::BufferTransmit() -- 
-//---------------------------------------------------------------------------
-void X6api::BufferTransmit()
+//------------------------------------------------------------------------------
+//  X6api::NextPatternRegion() -- Region to load into, the idle one in ping-pong
+//------------------------------------------------------------------------------
+int  X6api::NextPatternRegion()
 {
-	//  Builds a N channel buffer
-	int channels = Module.Output().ActiveChannels();
-	int bits = Module.Output().Info().Bits();
-	int samples = static_cast<int>(Settings.Tx.Pattern.SizeInEvents);
+	if (!Settings.Tx.Pattern.PingPong || Settings.Tx.LoadedPatterns.empty())
+		return 0;
+	return 1 - FPatternRegion;
+}
 
-	//  Pack SIDs Array
-	std::vector<int> sids;
-	int sid_0 = Module.VitaOut().VitaStreamId(0);
-	int sid_1 = Module.VitaOut().VitaStreamId(1);
-	if (Module.Output().ChannelEnabled(0) || Module.Output().ChannelEnabled(1))
-		sids.push_back(sid_0);
-	if (Module.Output().ChannelEnabled(2) || Module.Output().ChannelEnabled(3))
-		sids.push_back(sid_1);
+//------------------------------------------------------------------------------
+//  X6api::PatternRegionFits() -- Check a load does not run into the other region
+//------------------------------------------------------------------------------
+bool  X6api::PatternRegionFits(int region, unsigned int size_in_words)
+{
+	if (!Settings.Tx.Pattern.PingPong)
+		return true;
+	unsigned int ping = Settings.Tx.Pattern.Addr;
+	unsigned int pong = Settings.Tx.Pattern.PongAddr;
+	unsigned int start = region ? pong : ping;
+	unsigned int other = region ? ping : pong;
+	if (start > other || size_in_words <= other - start)
+		return true;
+	cout << "Error: pattern of " << size_in_words << " words overruns ping-pong region " << region << "\n";
+	return false;
+}
 
-	// build waveform buffer
-	Builder.set_wavedata(wavedata_);
-	Builder.Format(sids, channels, bits, samples);
-	Builder.BuildWave(WaveformPacket);
-	// In pattern mode directly send it
-	if (Module.Output().Pattern().PatternModeEnable())
+//------------------------------------------------------------------------------
+//  X6api::PatternLoadCommand() --
+//------------------------------------------------------------------------------
+//  In ping-pong mode the pattern goes to the idle region while the current
+//  one keeps replaying; the replays switch over at the next trigger.
+void  X6api::PatternLoadCommand()
+{
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+	WaitPatternLoad();
+	int region = NextPatternRegion();
+	unsigned int addr = region ? Settings.Tx.Pattern.PongAddr : Settings.Tx.Pattern.Addr;
+	if (!PatternRegionFits(region, PatternSize()))
+		return;
+
+	//  A rejected waveform never reaches pattern memory, keep the old database
+	TxSettings::PatternDBArray previous;
+	previous.swap(Settings.Tx.LoadedPatterns);
+	if (!LoadPattern("ArbWave", addr))
 	{
-		Stream.Send(WaveformPacket);
+		Settings.Tx.LoadedPatterns.swap(previous);
+		return;
 	}
+	Settings.Tx.Pattern.DB_Selection = 0;
+	FSequenceSteps.clear();
+	FPatternRegion = region;
+	ProgramReplays();
 }
 
 //------------------------------------------------------------------------------
-//  X6api::PatternSize() -- Calculate Size of Pattern in words
+//  X6api::pattern_load_async() -- PatternLoadCommand() on a worker thread
 //------------------------------------------------------------------------------
-unsigned int  X6api::PatternSize()
+//  wavedata_ and the settings are captured before returning, so the next
+//  waveform may be written and the settings changed while this one uploads.
+//  Other pattern commands wait for the worker to finish.
+bool  X6api::pattern_load_async()
 {
-	unsigned int sizeInSamples = Settings.Tx.Pattern.SizeInEvents * Module.Output().ActiveChannels();
-
-	return sizeInSamples * sizeof(short) / sizeof(int);
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+	if (pattern_load_pending())
+	{
+		cout << "Error: a pattern load is already in progress \n";
+		return false;
+	}
+	int region = NextPatternRegion();
+	unsigned int addr = region ? Settings.Tx.Pattern.PongAddr : Settings.Tx.Pattern.Addr;
+	unsigned int size = PatternSize();
+	if (!PatternRegionFits(region, size))
+		return false;
+
+	PrepareWaveform();
+	GetPatternInfo(FLoadInfo);
+	FLoadClipPolicy = Settings.Tx.ClipPolicy;
+	FLoadCancel = false;
+	FLoadProgress = 0.;
+	FLoadUploaded = false;
+	FLoadJoining = false;
+	FLoadRegion = region;
+	FLoadAddr = addr;
+	FLoadSize = size;
+	FLoadTask = std::async(std::launch::async, &X6api::PatternLoadTask, this).share();
+	return true;
 }
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
-//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+
+//------------------------------------------------------------------------------
+//  X6api::PatternLoadTask() -- Worker body of pattern_load_async()
+//------------------------------------------------------------------------------
+//  Progress is 0.5 once quantized, then rises with each chunk uploaded. A cancel is honoured
+//  up to the upload, so pattern memory is either untouched or complete.
+//  The database and replays are only updated under FCallLock. A caller that
+//  already holds it while waiting for the worker publishes them instead, so
+//  the worker never blocks on the lock.
+bool  X6api::PatternLoadTask()
+{
+	bool built = QuantizeWaveform(FLoadClipPolicy);
+	FLoadProgress = 0.5;
+	if (!built || FLoadCancel)
+		return false;
+
+	UploadPattern(FLoadAddr, FLoadSize, FLoadInfo);
+	FLoadUploaded = true;
+	while (!FLoadJoining)
+	{
+		std::unique_lock<std::recursive_mutex> lock(FCallLock, std::try_to_lock);
+		if (lock.owns_lock())
+		{
+			PublishPatternLoad();
+			break;
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::PublishPatternLoad() -- Point database and replays at an uploaded load
+//------------------------------------------------------------------------------
+//  Called with FCallLock held; does nothing unless the worker has uploaded.
+void  X6api::PublishPatternLoad()
+{
+	if (!FLoadUploaded)
+		return;
+	FLoadUploaded = false;
+	Settings.Tx.LoadedPatterns.clear();
+	Settings.Tx.LoadedPatterns.push_back(TxSettings::PatternDBEntry("ArbWave", FLoadAddr, FLoadSize));
+	Settings.Tx.Pattern.DB_Selection = 0;
+	FSequenceSteps.clear();
+	FPatternRegion = FLoadRegion;
+	ProgramReplays();
+	FLoadProgress = 1.;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::pattern_load_pending() --
+//------------------------------------------------------------------------------
+bool  X6api::pattern_load_pending()
+{
+	return FLoadTask.valid() &&
+		FLoadTask.wait_for(std::chrono::seconds(0)) != std::future_status::ready;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::wait_pattern_load() -- false if still loading after timeout_ms
+//------------------------------------------------------------------------------
+bool  X6api::wait_pattern_load(double timeout_ms)
+{
+	if (!FLoadTask.valid())
+		return true;
+	if (FLoadTask.wait_for(std::chrono::duration<double, std::milli>(timeout_ms)) !=
+		std::future_status::ready)
+		return false;
+	//  Published by now, unless the worker left it to a caller still holding the lock
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+	PublishPatternLoad();
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::pattern_load_result() -- wait, true if the last async load completed
+//------------------------------------------------------------------------------
+bool  X6api::pattern_load_result()
+{
+	WaitPatternLoad();
+	return FLoadTask.valid() && FLoadTask.get();
+}
+
+//------------------------------------------------------------------------------
+//  X6api::WaitPatternLoad() -- Serialize with a pending async load
+//------------------------------------------------------------------------------
+//  Pattern commands call this first. Setters need not: the worker only
+//  reads what pattern_load_async() captured.
+void  X6api::WaitPatternLoad()
+{
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+	if (!FLoadTask.valid())
+		return;
+	FLoadJoining = true;
+	FLoadTask.wait();
+	PublishPatternLoad();
+}
+
+//------------------------------------------------------------------------------
+//  X6api::ProgramReplays() -- Prepare the replay commands of the loaded patterns
+//------------------------------------------------------------------------------
+//  Trigger edges only post to Replays, so stream ids, database lookups and
+//  repeat settings are resolved here, once per load or stream start.
+ReplayQueue::CommandList  X6api::ProgramReplays()
+{
+	std::vector<ReplayQueue::Command> commands;
+	if (Settings.Tx.LoadedPatterns.empty())
+		return Replays.Program(commands);
+
+	ReplayQueue::Command cmd;
+	cmd.Mode = Settings.Tx.Pattern.LoopMode ?
+		IPatternModeSystem::prPlayAgain :
+		IPatternModeSystem::prFlatline;
+	//  Pack SIDs, Tags Arrays
+	PatternStreamIds(cmd.Sids, cmd.Tags);
+	//
+	//  A loaded sequence replays every step, reusing the shared blocks
+	if (!FSequenceSteps.empty())
+	{
+		const std::vector<PatternSequence::Step> & steps = FSequenceSteps;
+		for (size_t i = 0; i < steps.size(); i++)
+		{
+			if (steps[i].Pattern >= Settings.Tx.LoadedPatterns.size())
+			{
+				cout << "Error: sequence step " << i << " refers to a pattern that is not loaded \n";
+				FSequenceSteps.clear();
+				commands.clear();
+				return Replays.Program(commands);
+			}
+			const TxSettings::PatternDBEntry & entry = Settings.Tx.LoadedPatterns[steps[i].Pattern];
+			cmd.Addr = entry.Addr;
+			cmd.SizeInWords = entry.SizeInWords;
+			cmd.RepCount = steps[i].RepCount;
+			commands.push_back(cmd);
+		}
+		return Replays.Program(commands);
+	}
+	//  Find pattern information from the database
+	int selection = Settings.Tx.Pattern.DB_Selection;
+	if (selection < 0 || static_cast<size_t>(selection) >= Settings.Tx.LoadedPatterns.size())
+	{
+		cout << "Error: pattern " << selection << " is not loaded \n";
+		return Replays.Program(commands);
+	}
+	const TxSettings::PatternDBEntry & entry = Settings.Tx.LoadedPatterns[selection];
+	cmd.Addr = entry.Addr;
+	cmd.SizeInWords = entry.SizeInWords;
+	cmd.RepCount = Settings.Tx.Pattern.RepCount;
+	commands.push_back(cmd);
+	return Replays.Program(commands);
+}
+
+//------------------------------------------------------------------------------
+//  X6api::SendReplay() -- Send one replay Info Packet
+//------------------------------------------------------------------------------
+PatternDoneQueue::DoneFuture  X6api::SendReplay(const ReplayQueue::Command & cmd)
+{
+	//  Registered first, the done alert may arrive as soon as the packet is sent
+	std::lock_guard<std::mutex> stream(FPatternStreamLock);
+	PatternDoneQueue::DoneFuture done = PatternDone.Expect();
+	Module.Output().Pattern().SendPatternInfo(
+		0, // pid 
+		cmd.Sids,
+		cmd.Tags,
+		cmd.Addr,
+		cmd.SizeInWords,
+		cmd.RepCount,
+		IPatternModeSystem::piReplay,
+		static_cast<IPatternModeSystem::PatternRepeatType>(cmd.Mode));
+	return done;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::PatternReplayCommand() -- Replay now, picking up changed settings
+//------------------------------------------------------------------------------
+//  Returns the completion of each replay sent, in order. Triggered replays
+//  are only counted; wait for those with wait_pattern_count().
+std::vector<PatternDoneQueue::DoneFuture>  X6api::PatternReplayCommand()
+{
+	WaitPatternLoad();
+	ReplayQueue::CommandList commands = ProgramReplays();
+	std::vector<PatternDoneQueue::DoneFuture> done;
+	for (size_t i = 0; i < commands->size(); i++)
+		done.push_back(SendReplay((*commands)[i]));
+	return done;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::pattern_done_count() -- replays completed since streaming started
+//------------------------------------------------------------------------------
+int  X6api::pattern_done_count()
+{
+	return static_cast<int>(PatternDone.Completed());
+}
+
+//------------------------------------------------------------------------------
+//  X6api::pattern_replays_pending() -- replays issued but not yet completed
+//------------------------------------------------------------------------------
+int  X6api::pattern_replays_pending()
+{
+	PatternDoneQueue::Counter done = PatternDone.Completed();
+	PatternDoneQueue::Counter issued = PatternDone.Issued();
+	return issued > done ? static_cast<int>(issued - done) : 0;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::wait_pattern_done() -- wait for every replay issued so far
+//------------------------------------------------------------------------------
+bool  X6api::wait_pattern_done(double timeout_ms)
+{
+	return PatternDone.WaitFor(PatternDone.Issued(), timeout_ms * 1e-3);
+}
+
+//------------------------------------------------------------------------------
+//  X6api::wait_pattern_count() -- wait until count replays have completed
+//------------------------------------------------------------------------------
+bool  X6api::wait_pattern_count(int count, double timeout_ms)
+{
+	if (count < 0)
+		return false;
+	return PatternDone.WaitFor(count, timeout_ms * 1e-3);
+}
+
+//------------------------------------------------------------------------------
+//  X6api::clear_sequence() --
+//------------------------------------------------------------------------------
+void  X6api::clear_sequence()
+{
+	Sequence.Clear();
+}
+
+//------------------------------------------------------------------------------
+//  X6api::add_sequence_block() -- blocks with identical wavedata are shared
+//------------------------------------------------------------------------------
+int  X6api::add_sequence_block(string label, vector<double> wavedata)
+{
+	return static_cast<int>(Sequence.AddBlock(label, wavedata));
+}
+
+//------------------------------------------------------------------------------
+//  X6api::add_sequence_step() --
+//------------------------------------------------------------------------------
+bool  X6api::add_sequence_step(string label, int repeats)
+{
+	if (repeats < 0 || !Sequence.AddStep(label, repeats))
+	{
+		cout << "Error: unknown sequence block " << label << "\n";
+		return false;
+	}
+	return true;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::SequenceLoadCommand() -- Load each unique block once
+//------------------------------------------------------------------------------
+void  X6api::SequenceLoadCommand()
+{
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
+	WaitPatternLoad();
+	int channels = Module.Output().ActiveChannels();
+	int framesize = Module.Output().Info().TriggerFrameGranularity();
+	int region = NextPatternRegion();
+	unsigned int addr = region ? Settings.Tx.Pattern.PongAddr : Settings.Tx.Pattern.Addr;
+	Sequence.Compile(addr, channels, framesize);
+	if (!PatternRegionFits(region, Sequence.SizeInWords()))
+		return;
+
+	TxSettings::PatternDBArray previous;
+	previous.swap(Settings.Tx.LoadedPatterns);
+	//
+	//  The blocks go through the user's wave buffers; put those back afterwards
+	std::vector<double> wavedata;
+	std::vector<short> wavecodes;
+	Innovative::WaveSegmentArray wavesegments;
+	wavedata.swap(wavedata_);
+	wavecodes.swap(wavecodes_);
+	wavesegments.swap(wavesegments_);
+	unsigned int events = Settings.Tx.Pattern.SizeInEvents;
+	auto restore = [&]()
+		{
+			wavedata_.swap(wavedata);
+			wavecodes_.swap(wavecodes);
+			wavesegments_.swap(wavesegments);
+			Settings.Tx.Pattern.SizeInEvents = events;
+		};
+
+	const std::vector<size_t> & patterns = Sequence.Patterns();
+	for (size_t i = 0; i < patterns.size(); i++)
+	{
+		const PatternSequence::Block & block = Sequence.Blocks()[patterns[i]];
+		wavedata_.assign(block.wavedata.begin(), block.wavedata.end());
+		wavedata_.resize(block.Samples, 0.);
+		wavecodes_.clear();
+		wavesegments_.clear();
+		Settings.Tx.Pattern.SizeInEvents = block.Samples / channels;
+		if (!LoadPattern(block.Label, block.Addr))
+		{
+			restore();
+			//  A partial load only overwrote the idle ping-pong region, so the
+			//  previous database and steps still describe the active one.
+			//  Otherwise nothing consistent is left to replay.
+			if (Settings.Tx.Pattern.PingPong)
+				Settings.Tx.LoadedPatterns.swap(previous);
+			else
+			{
+				Settings.Tx.LoadedPatterns.clear();
+				Settings.Tx.Pattern.DB_Selection = 0;
+				FSequenceSteps.clear();
+			}
+			ProgramReplays();
+			return;
+		}
+	}
+	restore();
+	Settings.Tx.Pattern.DB_Selection = 0;
+	FSequenceSteps = Sequence.Steps();
+	FPatternRegion = region;
+	ProgramReplays();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::BufferTransmit() -- 
+//---------------------------------------------------------------------------
+void X6api::BufferTransmit()
+{
+	WaitPatternLoad();
+	if (!BuildWaveform())
+		return;
+	// In pattern mode directly send it
+	if (Module.Output().Pattern().PatternModeEnable())
+	{
+		std::lock_guard<std::mutex> stream(FPatternStreamLock);
+		UploadWaveform();
+	}
+}
+
+//---------------------------------------------------------------------------
+//  X6api::UploadWaveform() -- Stream the built wave in UploadChunkSize chunks
+//---------------------------------------------------------------------------
+void X6api::UploadWaveform()
+{
+	Builder.Packetize([this](VeloBuffer & chunk, double sent)
+		{
+			Stream.Send(chunk);
+			FLoadProgress = 0.5 + 0.5*sent;
+		});
+}
+
+//---------------------------------------------------------------------------
+//  X6api::BuildWaveform() -- Quantize into DAC codes, apply ClipPolicy
+//---------------------------------------------------------------------------
+bool X6api::BuildWaveform()
+{
+	PrepareWaveform();
+	return QuantizeWaveform(Settings.Tx.ClipPolicy);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::PrepareWaveform() -- Hand the wave and its settings to the Builder
+//---------------------------------------------------------------------------
+void X6api::PrepareWaveform()
+{
+	//  Builds a N channel buffer
+	int channels = Module.Output().ActiveChannels();
+	int bits = Module.Output().Info().Bits();
+	int samples = static_cast<int>(Settings.Tx.Pattern.SizeInEvents);
+
+	//  Pack SIDs Array, and the calibration of the enabled channels in the
+	//  order the Builder interleaves them
+	std::vector<int> sids;
+	FloatArray gain, offset, iq_skew;
+	for (int dev = 0; dev < 2; ++dev)
+	{
+		if (Module.Output().ChannelEnabled(2*dev) || Module.Output().ChannelEnabled(2*dev + 1))
+		{
+			sids.push_back(Module.VitaOut().VitaStreamId(dev));
+			for (int ch = 2*dev; ch < 2*dev + 2; ++ch)
+			{
+				if (!Module.Output().ChannelEnabled(ch))
+					continue;
+				gain.push_back(Settings.Tx.Gain[ch]);
+				offset.push_back(Settings.Tx.Offset[ch]);
+			}
+			iq_skew.push_back(Settings.Tx.IqSkew[dev]);
+		}
+	}
+
+	// build waveform buffer
+	if (!wavesegments_.empty())
+		Builder.set_segments(wavesegments_);
+	else if (!wavecodes_.empty())
+		Builder.set_codes(wavecodes_);
+	else
+		Builder.set_wavedata(wavedata_);
+	if (Settings.Tx.Calibrated)
+		Builder.set_calibration(gain, offset, iq_skew);
+	else
+		Builder.clear_calibration();
+	Builder.AutoScale(Settings.Tx.AutoScale);
+	Builder.ChunkSize(Settings.Tx.UploadChunkSize);
+	Builder.MaxInFlight(Settings.Tx.UploadInFlight);
+	Builder.Format(sids, channels, bits, samples);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::QuantizeWaveform() -- Quantize the prepared wave, ready to upload
+//---------------------------------------------------------------------------
+bool X6api::QuantizeWaveform(int clip_policy)
+{
+	if (!Builder.Quantize())
+	{
+		cout << "Error: DAC waveform data does not cover the pattern size \n";
+		return false;
+	}
+
+	// Range check, gathered while quantizing
+	if (Builder.Clipped() && clip_policy != cpSaturate)
+	{
+		const std::vector<DacChannelStats> & stats = Builder.Stats();
+		for (size_t ch = 0; ch < stats.size(); ch++)
+		{
+			if (!stats[ch].Clipped)
+				continue;
+			cout << (clip_policy == cpReject ? "Error" : "Warning")
+				<< ": DAC wave channel " << ch << " clipped " << stats[ch].Clipped
+				<< " samples, first at " << stats[ch].FirstClip << "\n";
+		}
+		if (clip_policy == cpReject)
+			return false;
+	}
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::dac_wave_stats() -- min, max, clip count, first clip per channel
+//---------------------------------------------------------------------------
+vector<double> X6api::dac_wave_stats()
+{
+	WaitPatternLoad();
+	const std::vector<DacChannelStats> & stats = Builder.Stats();
+	vector<double> result;
+	for (size_t ch = 0; ch < stats.size(); ch++)
+	{
+		result.push_back(stats[ch].Min);
+		result.push_back(stats[ch].Max);
+		result.push_back(static_cast<double>(stats[ch].Clipped));
+		result.push_back(static_cast<double>(stats[ch].FirstClip));
+	}
+	return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::dac_upload_timings() -- words, pack us, send us per chunk of the
+//                                 last upload
+//---------------------------------------------------------------------------
+vector<double> X6api::dac_upload_timings()
+{
+	WaitPatternLoad();
+	const std::vector<ArbWaveBuilder::ChunkTiming> & timings = Builder.ChunkTimings();
+	vector<double> result;
+	for (size_t i = 0; i < timings.size(); i++)
+	{
+		result.push_back(static_cast<double>(timings[i].Words));
+		result.push_back(timings[i].Pack * 1e6);
+		result.push_back(timings[i].Send * 1e6);
+	}
+	return result;
+}
+
+//------------------------------------------------------------------------------
+//  X6api::PatternSize() -- Calculate Size of Pattern in words
+//------------------------------------------------------------------------------
+unsigned int  X6api::PatternSize()
+{
+	unsigned int sizeInSamples = Settings.Tx.Pattern.SizeInEvents * Module.Output().ActiveChannels();
+
+	return sizeInSamples * sizeof(short) / sizeof(int);
+}
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 
 
 
@@ -689,11 +1836,11 @@ bool X6api::PllLocked()
 //---------------------------------------------------------------------------
 void X6api::write_wishbone_register(uint32_t baseAddr, uint32_t offset, uint32_t data)
 {
-	// Initialize WishboneAddress Space for APS specific firmware
-	Innovative::AddressingSpace & logicMemory = Innovative::LogicMemorySpace(const_cast<X6_1000M&>(Module));
-	Innovative::WishboneBusSpace WB_X6 = Innovative::WishboneBusSpace(logicMemory, baseAddr);
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	if (!FShadow.Write(baseAddr, offset, data))
+		return;
 	//Register.Value is defined as an ii32 in HardwareRegister_Mb.cpp and ii32 is typedefed as unsigend in DataTypes_Mb.h
-	Innovative::Register reg = Register(WB_X6, offset);
+	Innovative::Register reg = Register(WishboneSpace(baseAddr), offset);
 	reg.Value(data);
 }
 
@@ -702,18 +1849,232 @@ void X6api::write_wishbone_register(uint32_t baseAddr, uint32_t offset, uint32_t
 //---------------------------------------------------------------------------
 uint32_t X6api::read_wishbone_register(uint32_t baseAddr, uint32_t offset) const
 {
-	Innovative::AddressingSpace & logicMemory = Innovative::LogicMemorySpace(const_cast<X6_1000M&>(Module));
-	Innovative::WishboneBusSpace WB_X6 = Innovative::WishboneBusSpace(logicMemory, baseAddr);
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	uint32_t value;
+	if (FShadow.Read(baseAddr, offset, value))
+		return value;
 	//Register.Value is defined as an ii32 in HardwareRegister_Mb.cpp and ii32 is typedefed as unsigend in DataTypes_Mb.h
-	Innovative::Register reg = Register(WB_X6, offset);
+	Innovative::Register reg = Register(WishboneSpace(baseAddr), offset);
 	return reg.Value();
 }
 
+//---------------------------------------------------------------------------
+//  X6api::WishboneSpace() --  bus space of baseAddr, built on first use
+//---------------------------------------------------------------------------
+//  Kept until Close(), on the logic memory space made by Open(); callers
+//  hold FWishboneLock.
+Innovative::WishboneBusSpace & X6api::WishboneSpace(uint32_t baseAddr) const
+{
+	WishboneSpaceMap::iterator it = FWishboneSpaces.find(baseAddr);
+	if (it == FWishboneSpaces.end())
+	{
+		// Initialize WishboneAddress Space for APS specific firmware
+		if (!FLogicMemory)
+			FLogicMemory.reset(new Innovative::LogicMemorySpace(const_cast<X6_1000M&>(Module)));
+		it = FWishboneSpaces.insert(std::make_pair(baseAddr, WishboneBusSpace(*FLogicMemory, baseAddr))).first;
+	}
+	return it->second;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::write_wishbone_batch() --  write rows of (base, offset, value) in order
+//---------------------------------------------------------------------------
+void X6api::write_wishbone_batch(const uint32_t * ops, int rows, int cols)
+{
+	if (cols != 3)
+	{
+		cout << "Error: wishbone write batch rows must be (base, offset, value) \n";
+		return;
+	}
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	for (int i = 0; i < rows; i++, ops += 3)
+	{
+		if (!FShadow.Write(ops[0], ops[1], ops[2]))
+			continue;
+		Innovative::Register reg = Register(WishboneSpace(ops[0]), ops[1]);
+		reg.Value(ops[2]);
+	}
+}
+
+//---------------------------------------------------------------------------
+//  X6api::read_wishbone_batch() --  read rows of (base, offset) into values
+//---------------------------------------------------------------------------
+//  values is malloc'd; through swig it becomes a numpy array that frees it.
+void X6api::read_wishbone_batch(const uint32_t * addrs, int rows, int cols,
+	uint32_t ** values, int * count)
+{
+	*count = 0;
+	*values = static_cast<uint32_t *>(std::malloc((rows > 0 ? rows : 1) * sizeof(uint32_t)));
+	if (cols != 2)
+	{
+		cout << "Error: wishbone read batch rows must be (base, offset) \n";
+		return;
+	}
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	for (int i = 0; i < rows; i++, addrs += 2)
+	{
+		uint32_t & value = (*values)[i];
+		if (FShadow.Read(addrs[0], addrs[1], value))
+			continue;
+		Innovative::Register reg = Register(WishboneSpace(addrs[0]), addrs[1]);
+		value = reg.Value();
+	}
+	*count = rows > 0 ? rows : 0;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::set_wishbone_cached() --  shadow a write-only or config register
+//---------------------------------------------------------------------------
+//  Never cache status registers or registers whose writes act as strobes.
+void X6api::set_wishbone_cached(uint32_t baseAddr, uint32_t offset, bool cached)
+{
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	FShadow.Cache(baseAddr, offset, cached);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::invalidate_wishbone_shadow() --  next access to each goes to the bus
+//---------------------------------------------------------------------------
+void X6api::invalidate_wishbone_shadow()
+{
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	FShadow.Invalidate();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::wishbone_shadow_stats() --  bus writes, skipped writes, shadow reads
+//---------------------------------------------------------------------------
+vector<double> X6api::wishbone_shadow_stats()
+{
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	const RegisterShadow::Statistics & st = FShadow.Stats();
+	vector<double> result;
+	result.push_back(static_cast<double>(st.Writes));
+	result.push_back(static_cast<double>(st.Skipped));
+	result.push_back(static_cast<double>(st.Served));
+	return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::load_register_program() --  parse a register program, -1 on error
+//---------------------------------------------------------------------------
+//  Returns the handle for run_register_program(); see reg_prog.h for syntax.
+//  Handles freed by unload_register_program() are reused first.
+int X6api::load_register_program(const std::string & text)
+{
+	Innovative::RegisterProgram program;
+	std::string error;
+	if (!program.Parse(text, error))
+	{
+		cout << "Error: register program " << error << " \n";
+		return -1;
+	}
+	if (program.Ops().empty())
+	{
+		cout << "Error: register program has no instructions \n";
+		return -1;
+	}
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	for (size_t i = 0; i < FPrograms.size(); i++)
+		if (FPrograms[i].Ops().empty())
+		{
+			FPrograms[i] = program;
+			return static_cast<int>(i);
+		}
+	FPrograms.push_back(program);
+	return static_cast<int>(FPrograms.size() - 1);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::unload_register_program() --  free a handle, false if not loaded
+//---------------------------------------------------------------------------
+bool X6api::unload_register_program(int program)
+{
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	if (program < 0 || program >= static_cast<int>(FPrograms.size())
+		|| FPrograms[program].Ops().empty())
+	{
+		cout << "Error: no register program " << program << " \n";
+		return false;
+	}
+	FPrograms[program] = Innovative::RegisterProgram();
+	while (!FPrograms.empty() && FPrograms.back().Ops().empty())
+		FPrograms.pop_back();
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::run_register_program() --  execute a loaded program, false on timeout
+//---------------------------------------------------------------------------
+//  Holds the wishbone lock throughout, so other register calls wait for the
+//  program to finish. Accesses go through the register shadow like single calls,
+//  except polls, which always read the bus.
+bool X6api::run_register_program(int program)
+{
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	if (program < 0 || program >= static_cast<int>(FPrograms.size())
+		|| FPrograms[program].Ops().empty())
+	{
+		cout << "Error: no register program " << program << " \n";
+		return false;
+	}
+
+	Innovative::RegisterProgram::ReadEvent read = [this](uint32_t base, uint32_t offset)
+	{
+		uint32_t value;
+		if (FShadow.Read(base, offset, value))
+			return value;
+		Innovative::Register reg = Register(WishboneSpace(base), offset);
+		return static_cast<uint32_t>(reg.Value());
+	};
+	Innovative::RegisterProgram::ReadEvent poll = [this](uint32_t base, uint32_t offset)
+	{
+		Innovative::Register reg = Register(WishboneSpace(base), offset);
+		return static_cast<uint32_t>(reg.Value());
+	};
+	Innovative::RegisterProgram::WriteEvent write = [this](uint32_t base, uint32_t offset, uint32_t value)
+	{
+		if (!FShadow.Write(base, offset, value))
+			return;
+		Innovative::Register reg = Register(WishboneSpace(base), offset);
+		reg.Value(value);
+	};
+
+	if (FPrograms[program].Run(read, poll, write, FProgramTrace))
+		return true;
+
+	const Innovative::RegisterProgram::Op & op = FPrograms[program].Ops()[FProgramTrace.back().Index];
+	cout << "Error: register program " << program << " timed out polling line " << op.Line << " \n";
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::register_program_trace() --  last run, 5 values per instruction
+//---------------------------------------------------------------------------
+//  Rows of (index, start us, duration us, value, ok), in execution order.
+vector<double> X6api::register_program_trace()
+{
+	std::lock_guard<std::mutex> lock(FWishboneLock);
+	vector<double> result;
+	result.reserve(FProgramTrace.size() * 5);
+	for (size_t i = 0; i < FProgramTrace.size(); i++)
+	{
+		const Innovative::RegisterProgram::Trace & t = FProgramTrace[i];
+		result.push_back(static_cast<double>(t.Index));
+		result.push_back(t.Start * 1e6);
+		result.push_back(t.Duration * 1e6);
+		result.push_back(static_cast<double>(t.Value));
+		result.push_back(t.Ok ? 1.0 : 0.0);
+	}
+	return result;
+}
+
 //---------------------------------------------------------------------------
 // X6api::WriteRom()
 //---------------------------------------------------------------------------
 void X6api::WriteRom()
 {
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
     //  System Page Operations
     Module.IdRom().System().Name(Settings.ModuleName);
     Module.IdRom().System().Revision(Settings.ModuleRevision);
@@ -746,6 +2107,7 @@ void X6api::WriteRom()
 //---------------------------------------------------------------------------
 void X6api::ReadRom()
 {
+	std::lock_guard<std::recursive_mutex> lock(FCallLock);
     //  System Page Operations
     Module.IdRom().System().LoadFromRom();
 
@@ -782,24 +2144,121 @@ bool X6api::DacInternalCal()
     return Module.Output().DacInternalCalibrationOk();
 }
 
+//---------------------------------------------------------------------------
+//  X6api::start_health_monitor() --  sample health every interval_ms
+//---------------------------------------------------------------------------
+//  Starts a new history; the sampler runs until stop_health_monitor(), Open() or
+//  Close(). Samples due while a driver call holds the module are skipped.
+bool X6api::start_health_monitor(double interval_ms)
+{
+    std::lock_guard<std::recursive_mutex> lock(FCallLock);
+    if (!FOpened)
+        {
+        cout << "Error: open the board before starting the health monitor \n";
+        return false;
+        }
+    Health.Interval(interval_ms * 1e-3);
+    return Health.Start();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::stop_health_monitor() --  history stays readable
+//---------------------------------------------------------------------------
+void X6api::stop_health_monitor()
+{
+    Health.Stop();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::health_latest() --  time (s), temperature, pll locked, dac cal ok
+//---------------------------------------------------------------------------
+//  Empty until the first sample.
+vector<double> X6api::health_latest()
+{
+    HealthMonitor::Sample sample;
+    vector<double> result;
+    if (!Health.Latest(sample))
+        return result;
+    result.push_back(sample.Time);
+    result.push_back(sample.Temperature);
+    result.push_back(sample.PllLocked ? 1.0 : 0.0);
+    result.push_back(sample.DacCalOk ? 1.0 : 0.0);
+    return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::health_history() --  samples of the last window_s seconds, oldest first
+//---------------------------------------------------------------------------
+//  Rows of 4 values, as health_latest().
+vector<double> X6api::health_history(double window_s)
+{
+    std::vector<HealthMonitor::Sample> samples;
+    Health.History(window_s, samples);
+    vector<double> result;
+    result.reserve(samples.size() * 4);
+    for (size_t i = 0; i < samples.size(); i++)
+        {
+        result.push_back(samples[i].Time);
+        result.push_back(samples[i].Temperature);
+        result.push_back(samples[i].PllLocked ? 1.0 : 0.0);
+        result.push_back(samples[i].DacCalOk ? 1.0 : 0.0);
+        }
+    return result;
+}
+
 //------------------------------------------------------------------------------
 //  X6api::ManualTrigger() --
 //------------------------------------------------------------------------------
 void  X6api::ManualTrigger(double state)
 {
+	TrigLog.Push(state ? TriggerLog::esManualHigh : TriggerLog::esManualLow);
 	Trig.SetActiveTrigger((bool)state);
 }
 
 
 //---------------------------------------------------------------------------
-//  X6api::FpgaLogicVersion() --
+//  X6api::ReadBoardInfo() --  query the board identification in one pass
 //---------------------------------------------------------------------------
-std::string X6api::FpgaLogicVersion()
+void X6api::ReadBoardInfo()
 {
+	BoardInfo info;
 	stringstream ss;
 	ss << std::hex << Module.Info().FpgaLogicVersion() << " Subrev "
-		<< FpgaLogicSubrevision();
-	return  ss.str();
+		<< Module.Info().FpgaLogicSubrevision();
+	info.FpgaLogicVersion = ss.str();
+	info.FpgaHardwareVariant = Module.Info().FpgaHardwareVariant();
+	info.PciLogicRevision = Module.Info().PciLogicRevision();
+	info.FpgaLogicSubrevision = Module.Info().FpgaLogicSubrevision();
+	info.PciLogicType = Module.BoardName(Module.Info().PciLogicType());
+
+	char RevNumber = 'A' + static_cast<char>(Module.Info().PciLogicPcb());
+	stringstream pcb;
+	pcb << "Rev" << RevNumber;
+	info.PciLogicPcb = pcb.str();
+
+	info.FpgaName = Module.FpgaName(Module.Info().FpgaChipType());
+
+	info.PCIExpressLaneCount = Module.Debug()->LaneCount();
+	info.PCIExpressGen2 = Module.Debug()->IsGen2Capable();
+	stringstream msg;
+	msg << "PCI Express Lanes: " << info.PCIExpressLaneCount;
+	if (info.PCIExpressGen2)
+		msg << " Gen 2";
+	else
+		msg << " Gen 1 only";
+	info.PCIExpressLanes = msg.str();
+
+	info.BitStreamDate = Module.Info().BitStreamDateString_YMD();
+	info.BitStreamTime = Module.Info().BitStreamDateString_HMS();
+	FBoardInfo = info;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::FpgaLogicVersion() --
+//---------------------------------------------------------------------------
+std::string X6api::FpgaLogicVersion()
+{
+	return  FBoardInfo.FpgaLogicVersion;
 }
 
 //---------------------------------------------------------------------------
@@ -807,7 +2266,7 @@ std::string X6api::FpgaLogicVersion()
 //---------------------------------------------------------------------------
 unsigned short X6api::FpgaHardwareVariant()
 {
-	return  Module.Info().FpgaHardwareVariant();
+	return  FBoardInfo.FpgaHardwareVariant;
 }
 
 //---------------------------------------------------------------------------
@@ -815,7 +2274,7 @@ unsigned short X6api::FpgaHardwareVariant()
 //---------------------------------------------------------------------------
 unsigned short X6api::PciLogicRevision()
 {
-	return  Module.Info().PciLogicRevision();
+	return  FBoardInfo.PciLogicRevision;
 }
 
 //---------------------------------------------------------------------------
@@ -823,7 +2282,7 @@ unsigned short X6api::PciLogicRevision()
 //---------------------------------------------------------------------------
 unsigned short X6api::FpgaLogicSubrevision()
 {
-	return  Module.Info().FpgaLogicSubrevision();
+	return  FBoardInfo.FpgaLogicSubrevision;
 }
 
 //---------------------------------------------------------------------------
@@ -831,7 +2290,7 @@ unsigned short X6api::FpgaLogicSubrevision()
 //---------------------------------------------------------------------------
 std::string X6api::PciLogicType()
 {
-	return Module.BoardName(Module.Info().PciLogicType());
+	return FBoardInfo.PciLogicType;
 }
 
 //---------------------------------------------------------------------------
@@ -839,10 +2298,7 @@ std::string X6api::PciLogicType()
 //---------------------------------------------------------------------------
 std::string X6api::PciLogicPcb()
 {
-	char RevNumber = 'A' + static_cast<char>(Module.Info().PciLogicPcb());
-	stringstream ss;
-	ss << "Rev" << RevNumber;
-	return ss.str();
+	return FBoardInfo.PciLogicPcb;
 }
 
 //---------------------------------------------------------------------------
@@ -850,7 +2306,7 @@ std::string X6api::PciLogicPcb()
 //---------------------------------------------------------------------------
 std::string X6api::FpgaName()
 {
-	return Module.FpgaName(Module.Info().FpgaChipType());
+	return FBoardInfo.FpgaName;
 }
 
 //---------------------------------------------------------------------------
@@ -858,14 +2314,7 @@ std::string X6api::FpgaName()
 //---------------------------------------------------------------------------
 std::string X6api::PCIExpressLanes()
 {
-	stringstream msg;
-	msg << "PCI Express Lanes: " << Module.Debug()->LaneCount();
-	if (Module.Debug()->IsGen2Capable())
-		msg << " Gen 2";
-	else
-		msg << " Gen 1 only";
-
-	return msg.str();
+	return FBoardInfo.PCIExpressLanes;
 }
 
 //---------------------------------------------------------------------------
@@ -873,7 +2322,7 @@ std::string X6api::PCIExpressLanes()
 //---------------------------------------------------------------------------
 std::string X6api::BitStreamDate()
 {
-	return Module.Info().BitStreamDateString_YMD();
+	return FBoardInfo.BitStreamDate;
 }
 
 //---------------------------------------------------------------------------
@@ -881,7 +2330,7 @@ std::string X6api::BitStreamDate()
 //---------------------------------------------------------------------------
 std::string X6api::BitStreamTime()
 {
-	return Module.Info().BitStreamDateString_HMS();
+	return FBoardInfo.BitStreamTime;
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -952,6 +2401,7 @@ void  X6api::HandleDisableTrigger(OpenWire::NotifyEvent & /*Event*/)
 //------------------------------------------------------------------------------
 void  X6api::HandleSoftwareTrigger(OpenWire::NotifyEvent & /*Event*/)
 {
+	TrigLog.Push(TriggerLog::esSoftware);
 	if (Settings.Tx.ExternalTrigger == 0)
 		Module.Output().SoftwareTrigger(true);
     if (Settings.Rx.ExternalTrigger == 0) 
@@ -965,10 +2415,8 @@ void  X6api::HandleManualTrigger(ManualTriggerEvent & Event)
 {
 	Module.Output().SoftwareTrigger(Event.State);
 	Module.Input().SoftwareTrigger(Event.State);
-	if (!Event.State && !Settings.Tx.LoadedPatterns.empty())
-	{
-		PatternReplayCommand();
-	}
+	if (!Event.State)
+		Replays.Post();
 }
 
 //---------------------------------------------------------------------------
@@ -1000,15 +2448,92 @@ void  X6api::HookAlerts()
 //---------------------------------------------------------------------------
 //  Alert Handlers
 //---------------------------------------------------------------------------
-void  X6api::HandleTimestampRolloverAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleSoftwareAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleWarningTempAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleInputFifoOverrunAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleOutputFifoUnderflowAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleTriggerAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleInputOverrangeAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandleOutputOverrangeAlert(Innovative::AlertSignalEvent & event){}
-void  X6api::HandlePatternDoneAlert(Innovative::AlertSignalEvent & event){}
+void  X6api::HandleTimestampRolloverAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akTimestampRollover, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleSoftwareAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akSoftware, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleWarningTempAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akWarningTemperature, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleInputFifoOverrunAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akInputOverflow, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleOutputFifoUnderflowAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akOutputUnderflow, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleTriggerAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akTrigger, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleInputOverrangeAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akInputOverrange, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandleOutputOverrangeAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akOutputOverrange, event.Argument, event.TimeInSeconds);
+}
+void  X6api::HandlePatternDoneAlert(Innovative::AlertSignalEvent & event)
+{
+	AlertEvents.Push(AlertLog::akPatternDone, event.Argument, event.TimeInSeconds);
+	PatternDone.Done();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::alert_counts() --  alerts of each kind since reset_alerts()
+//---------------------------------------------------------------------------
+//  rollover, software, temperature, input overflow, output underflow,
+//  trigger, input overrange, output overrange, pattern done
+vector<double> X6api::alert_counts()
+{
+	std::vector<unsigned long long> counts;
+	AlertEvents.Counts(counts);
+	return vector<double>(counts.begin(), counts.end());
+}
+
+//---------------------------------------------------------------------------
+//  X6api::alert_log() --  rows of (host s, board s, kind, argument)
+//---------------------------------------------------------------------------
+//  Holds the latest 4096 alerts; alert_log_dropped() tells how many were lost.
+vector<double> X6api::alert_log()
+{
+	std::vector<AlertLog::Record> records;
+	AlertEvents.Snapshot(records);
+	vector<double> result;
+	result.reserve(records.size() * 4);
+	for (size_t i = 0; i < records.size(); i++)
+	{
+		result.push_back(records[i].Time);
+		result.push_back(records[i].BoardTime);
+		result.push_back(records[i].Kind);
+		result.push_back(records[i].Argument);
+	}
+	return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::alert_log_dropped() --  alerts counted but no longer in the log
+//---------------------------------------------------------------------------
+int X6api::alert_log_dropped()
+{
+	std::vector<AlertLog::Record> records;
+	return static_cast<int>(AlertEvents.Snapshot(records));
+}
+
+//---------------------------------------------------------------------------
+//  X6api::reset_alerts() --  zero the counters and clear the log
+//---------------------------------------------------------------------------
+void X6api::reset_alerts()
+{
+	AlertEvents.Reset();
+}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1023,22 +2548,161 @@ void  X6api::HandlePatternDoneAlert(Innovative::AlertSignalEvent & event){}
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //---------------------------------------------------------------------------
-//  X6api::read_adc_data() --  read adc data
+//  X6api::do_trigger() --  issue trig_n manual triggers, wait for the train
 //---------------------------------------------------------------------------
 void X6api::do_trigger(int trig_n)
 {
-	int idx = trig_n;
-	while (idx)
+	if (trig_n <= 0)
+		return;
+	start_trigger_train(trig_n);
+	wait_trigger_train();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::start_trigger_train() --  trig_n manual triggers, 0 until stopped
+//---------------------------------------------------------------------------
+bool X6api::start_trigger_train(int trig_n)
+{
+	//  No edge of the previous train may land in the new run's log
+	TrigTrain.Stop();
+	TrigTrain.Period(Settings.TriggerPeriod * 1e-6);
+	TrigLog.Reset();
+	if (!TrigTrain.Start(trig_n > 0 ? trig_n : 0))
 	{
-		ManualTrigger(0);
-		Innovative::Sleep(1);
-		ManualTrigger(1);
-		idx--;
+		cout << "Error: trigger period must be positive \n";
+		return false;
 	}
+	return true;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::stop_trigger_train() --
+//---------------------------------------------------------------------------
+void X6api::stop_trigger_train()
+{
+	TrigTrain.Stop();
 }
+
+//---------------------------------------------------------------------------
+//  X6api::wait_trigger_train() --
+//---------------------------------------------------------------------------
+bool X6api::wait_trigger_train()
+{
+	TrigTrain.Wait();
+	std::string error = TrigTrain.Error();
+	if (error.empty())
+		return true;
+	cout << "Error: trigger train stopped: " << error << " \n";
+	return false;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::trigger_stats() --  triggers, overruns, mean/min/max period,
+//                             jitter and max lateness (seconds)
+//---------------------------------------------------------------------------
+vector<double> X6api::trigger_stats()
+{
+	TriggerScheduler::Statistics st = TrigTrain.Stats();
+	vector<double> result;
+	result.push_back(st.Triggers);
+	result.push_back(st.Overruns);
+	result.push_back(st.MeanPeriod);
+	result.push_back(st.MinPeriod);
+	result.push_back(st.MaxPeriod);
+	result.push_back(st.Jitter);
+	result.push_back(st.MaxLateness);
+	return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::trigger_timestamps() --  trigger edge times of the last run, us
+//---------------------------------------------------------------------------
+vector<double> X6api::trigger_timestamps()
+{
+	std::vector<TriggerLog::Record> records;
+	TrigLog.Snapshot(records);
+	vector<double> result;
+	for (size_t i = 0; i < records.size(); i++)
+		if (records[i].Source != TriggerLog::esManualHigh)
+			result.push_back(records[i].Time * 1e6);
+	return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::trigger_period_histogram() --  trigger intervals in bins of bin us
+//---------------------------------------------------------------------------
+vector<int> X6api::trigger_period_histogram(double bin, int bins)
+{
+	vector<int> counts;
+	TrigLog.PeriodHistogram(bin * 1e-6, bins > 0 ? bins : 0, counts);
+	return counts;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::trigger_jitter_percentiles() --  lateness vs schedule, us
+//---------------------------------------------------------------------------
+vector<double> X6api::trigger_jitter_percentiles(vector<double> percents)
+{
+	vector<double> result;
+	TrigLog.LatenessPercentiles(percents, result);
+	for (size_t i = 0; i < result.size(); i++)
+		result[i] *= 1e6;
+	return result;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::trigger_missed_deadlines() --  edges a whole period late
+//---------------------------------------------------------------------------
+int X6api::trigger_missed_deadlines()
+{
+	return static_cast<int>(TrigLog.MissedDeadlines(Settings.TriggerPeriod * 1e-6));
+}
+
+//---------------------------------------------------------------------------
+//  X6api::read_adc_data() --  copy of the capture, see read_adc_array()
+//---------------------------------------------------------------------------
 vector<int> X6api::read_adc_data()
 {
-	return adc_data_;
+	std::lock_guard<std::mutex> lock(FCaptureLock);
+	return vector<int>(FCapture, FCapture + FCaptureSize);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::read_adc_array() --  move the capture out, numpy frees it
+//---------------------------------------------------------------------------
+//  Shaped (repeats, channels, samples) as captured by the last run. A capture
+//  that is not whole triggers comes back as (1, 1, size). The capture is
+//  handed over, so a later read_adc_data() returns nothing.
+void X6api::read_adc_array(short ** data, int * repeats, int * channels, int * samples)
+{
+	std::lock_guard<std::mutex> lock(FCaptureLock);
+	size_t trigger = FCaptureChannels * FCaptureSamples;
+	*repeats = 1;
+	*channels = 1;
+	*samples = static_cast<int>(FCaptureSize);
+	if (FCaptureSize && trigger && FCaptureSize % trigger == 0)
+	{
+		*repeats = static_cast<int>(FCaptureSize / trigger);
+		*channels = static_cast<int>(FCaptureChannels);
+		*samples = static_cast<int>(FCaptureSamples);
+	}
+	//  Hand over a valid pointer even when empty
+	*data = FCapture ? FCapture : static_cast<short *>(std::malloc(sizeof(short)));
+	FCapture = 0;
+	FCaptureSize = 0;
+	FCaptureCapacity = 0;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::ReleaseCapture() --
+//---------------------------------------------------------------------------
+void X6api::ReleaseCapture()
+{
+	std::lock_guard<std::mutex> lock(FCaptureLock);
+	std::free(FCapture);
+	FCapture = 0;
+	FCaptureSize = 0;
+	FCaptureCapacity = 0;
 }
 
 //---------------------------------------------------------------------------
@@ -1047,25 +2711,165 @@ vector<int> X6api::read_adc_data()
 void X6api::write_dac_wavedata(vector<double> wavedata)
 {
 	// clear wavedata_, in case there already has historical data in it
-	wavedata_.clear();
-	wavedata_.swap(vector<double>());
+	wavesegments_.clear();
+	vector<short>().swap(wavecodes_);
 	// copy data into it
 	wavedata_.swap(wavedata);
 	
 	// make sure wavedata size is multiple of output TriggerFrameGranularity
+	wavedata_.resize(FramedWaveSize(wavedata_.size()), 0.);
+	SetWaveSize(wavedata_.size());
+}
+
+//---------------------------------------------------------------------------
+//  X6api::write_dac_array() --  float64 samples, interleaved by channel
+//---------------------------------------------------------------------------
+void X6api::write_dac_array(const double * wave, int length)
+{
+	wavesegments_.clear();
+	vector<short>().swap(wavecodes_);
+	size_t samples = length > 0 ? length : 0;
+	wavedata_.assign(wave, wave + samples);
+	wavedata_.resize(FramedWaveSize(samples), 0.);
+	SetWaveSize(wavedata_.size());
+}
+
+//---------------------------------------------------------------------------
+//  X6api::write_dac_array_f32() --  float32 samples, widened once here
+//---------------------------------------------------------------------------
+void X6api::write_dac_array_f32(const float * wave, int length)
+{
+	wavesegments_.clear();
+	vector<short>().swap(wavecodes_);
+	size_t samples = length > 0 ? length : 0;
+	wavedata_.assign(wave, wave + samples);
+	wavedata_.resize(FramedWaveSize(samples), 0.);
+	SetWaveSize(wavedata_.size());
+}
+
+//---------------------------------------------------------------------------
+//  X6api::write_dac_codes() --  int16 DAC codes, bypass quantization
+//---------------------------------------------------------------------------
+//  Calibration, auto-scale and clip checks do not apply to ready-made codes.
+void X6api::write_dac_codes(const short * codes, int length)
+{
+	wavesegments_.clear();
+	vector<double>().swap(wavedata_);
+	size_t samples = length > 0 ? length : 0;
+	wavecodes_.assign(codes, codes + samples);
+	wavecodes_.resize(FramedWaveSize(samples), 0);
+	SetWaveSize(wavecodes_.size());
+}
+
+//---------------------------------------------------------------------------
+//  X6api::FramedWaveSize() --  samples padded to TriggerFrameGranularity
+//---------------------------------------------------------------------------
+size_t X6api::FramedWaveSize(size_t samples)
+{
 	int framesize = Module.Output().Info().TriggerFrameGranularity();
-	int res = wavedata_.size() % framesize;
+	int res = samples % framesize;
 	if (res)
+		samples += framesize - res;
+	return samples;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::SetWaveSize() --  Tx frame and pattern size of a framed waveform
+//---------------------------------------------------------------------------
+void X6api::SetWaveSize(size_t samples)
+{
+	int channels = Module.Output().ActiveChannels();
+	Settings.Tx.Pattern.SizeInEvents = samples / channels;
+	Settings.Tx.FrameSize = samples;
+}
+
+//---------------------------------------------------------------------------
+//  X6api::clear_dac_segments() --
+//---------------------------------------------------------------------------
+void X6api::clear_dac_segments()
+{
+	wavesegments_.clear();
+}
+
+//---------------------------------------------------------------------------
+//  X6api::add_dac_constant() -- level holds one value per active channel
+//---------------------------------------------------------------------------
+void X6api::add_dac_constant(int length, vector<double> level)
+{
+	if (level.size() != static_cast<size_t>(Module.Output().ActiveChannels()))
 	{
-		for (int idx = 0; idx < (framesize - res); idx++)
-		{
-			wavedata_.push_back(0);
-		}
+		cout << "Error: segment level needs one value per active channel \n";
+		return;
+	}
+	WaveSegment seg;
+	seg.Type = WaveSegment::stConstant;
+	seg.Length = length;
+	seg.Start.swap(level);
+	wavesegments_.push_back(seg);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::add_dac_ramp() -- linear from start towards stop over length
+//---------------------------------------------------------------------------
+void X6api::add_dac_ramp(int length, vector<double> start, vector<double> stop)
+{
+	size_t channels = Module.Output().ActiveChannels();
+	if (start.size() != channels || stop.size() != channels)
+	{
+		cout << "Error: segment ramp needs one value per active channel \n";
+		return;
+	}
+	WaveSegment seg;
+	seg.Type = WaveSegment::stRamp;
+	seg.Length = length;
+	seg.Start.swap(start);
+	seg.Stop.swap(stop);
+	wavesegments_.push_back(seg);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::add_dac_samples() -- interleaved like write_dac_wavedata()
+//---------------------------------------------------------------------------
+void X6api::add_dac_samples(vector<double> wavedata)
+{
+	size_t channels = Module.Output().ActiveChannels();
+	if (!channels || wavedata.size() % channels)
+	{
+		cout << "Error: segment samples must be a multiple of the active channels \n";
+		return;
 	}
+	WaveSegment seg;
+	seg.Type = WaveSegment::stSampled;
+	seg.Length = static_cast<unsigned int>(wavedata.size() / channels);
+	seg.Samples.swap(wavedata);
+	wavesegments_.push_back(seg);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::add_dac_repeat() -- replay the last span segments count more times
+//---------------------------------------------------------------------------
+void X6api::add_dac_repeat(int span, int count)
+{
+	WaveSegment seg;
+	seg.Type = WaveSegment::stRepeat;
+	seg.Span = span;
+	seg.Length = count;
+	wavesegments_.push_back(seg);
+}
+
+//---------------------------------------------------------------------------
+//  X6api::write_dac_segments() -- use the segments as the DAC waveform
+//---------------------------------------------------------------------------
+void X6api::write_dac_segments()
+{
+	// segments replace any sampled wavedata
+	vector<double>().swap(wavedata_);
+	vector<short>().swap(wavecodes_);
 
+	// make sure events are multiple of output TriggerFrameGranularity,
+	// the builder pads the tail with zero level
 	int channels = Module.Output().ActiveChannels();
-	Settings.Tx.Pattern.SizeInEvents = wavedata_.size() / channels;
-	Settings.Tx.FrameSize = wavedata_.size();
+	SetWaveSize(FramedWaveSize(SegmentEvents(wavesegments_) * channels));
 }
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
 //~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
@@ -1116,7 +2920,7 @@ void main()
 	for (int idx = 0; idx<ADC_Data.size(); idx++)
 	{
 		out << ADC_Data[idx];
-		if ((idx + 1) % (2048+16))
+		if ((idx + 1) % 2048)
 		{
 			out << "  ";
 		}
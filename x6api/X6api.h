@@ -8,7 +8,23 @@
 #define X6apiH
 
 #include "arb_wf.h"
+#include "pattern_seq.h"
+#include "trig_sched.h"
+#include "pattern_done.h"
+#include "replay_queue.h"
+#include "reg_shadow.h"
+#include "reg_prog.h"
+#include "settings_io.h"
+#include "health_mon.h"
+#include "alert_log.h"
 #include <array>
+#include <map>
+#include <tuple>
+#include <chrono>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <stdint.h>
 #include <X6_1000M_Mb.h>
 #include <VitaPacketStream_Mb.h>
@@ -73,12 +89,18 @@ struct TxSettings
     //  Streaming
 	int             PacketSize;
     bool            AutoPreconfig;
+    int             ClipPolicy;     // Innovative::DacClipPolicy
+    int             AutoScale;      // Innovative::DacAutoScale
+    int             UploadChunkSize;    // words per device per DMA chunk, 0 for one buffer
+    int             UploadInFlight;     // chunks packed ahead of the DMA
     //
     //  Not saved in INI file
     //  ..Eeprom
     FloatArray      Gain;
     FloatArray      Offset;
     bool            Calibrated;
+    //  ..IQ phase skew per DAC device (radians), applied with Gain/Offset
+    FloatArray      IqSkew;
 
     struct PatternModeSettings
     {
@@ -90,6 +112,9 @@ struct TxSettings
         int           DB_Selection;
         std::string   DB_Label;
         bool          LoopMode;
+        //  Ping-pong mode loads into the region that is not replaying
+        bool          PingPong;
+        unsigned int  PongAddr;     // second region, Addr is the first
     };
     // Pattern
     PatternModeSettings  Pattern;
@@ -126,6 +151,9 @@ struct ApplicationSettings
     float           ReferenceRate;
     int             SampleClockSource;
     int             ExtTriggerSrcSelection;
+    double          TriggerPeriod;      // manual trigger train, unit us
+    double          PllLockTimeout;     // wait for relock after a rate change, unit ms
+    bool            TriggerAlerts;      // log an alert per trigger, off by default
     //
     std::string     ModuleName;
     std::string     ModuleRevision;
@@ -134,6 +162,31 @@ struct ApplicationSettings
     TxSettings      Tx;
 };
 
+//==============================================================================
+//  CLASS BoardInfo  -- Board identification, read once at Open
+//==============================================================================
+
+struct BoardInfo
+{
+    std::string     FpgaLogicVersion;
+    unsigned short  FpgaHardwareVariant;
+    unsigned short  PciLogicRevision;
+    unsigned short  FpgaLogicSubrevision;
+    std::string     PciLogicType;
+    std::string     PciLogicPcb;
+    std::string     FpgaName;
+    int             PCIExpressLaneCount;
+    bool            PCIExpressGen2;
+    std::string     PCIExpressLanes;
+    std::string     BitStreamDate;
+    std::string     BitStreamTime;
+
+    BoardInfo()
+        : FpgaHardwareVariant(0), PciLogicRevision(0), FpgaLogicSubrevision(0),
+          PCIExpressLaneCount(0), PCIExpressGen2(false)
+        {}
+};
+
 
 //===========================================================================
 //  CLASS X6api  -- Hardware Access and Application Io Class
@@ -147,14 +200,32 @@ public:
 
     // Methods
 	void	do_trigger(int trig_n);
+	bool	start_trigger_train(int trig_n);
+	void	stop_trigger_train();
+	// false if an edge failed and stopped the train
+	bool	wait_trigger_train();
+	vector<double>	trigger_stats();
+	vector<double>	trigger_timestamps();
+	vector<int>	trigger_period_histogram(double bin, int bins);
+	vector<double>	trigger_jitter_percentiles(vector<double> percents);
+	int 	trigger_missed_deadlines();
     unsigned int    BoardCount();
     vector<string>  BoardNames();
     string          PrintDevices();
 	void            ParaInit();
 	void            Open(int target);
+	// attaches without Module.Reset() when the board still runs the profile; the
+	// token register must be a firmware scratch register cleared by reset and power-up.
+	// Only the reset is saved: the first StreamPreconfigure() after a warm attach
+	// still runs Stream.Preconfigure() and the PLL wait, and writes a new token
+	bool            open_warm(int target, const std::string & profile,
+	                          uint32_t token_base, uint32_t token_offset);
     bool            IsOpen(){  return FOpened;  }
     void            Close();
-	void            StreamPreconfigure();
+	// false if the PLLs did not lock within PllLockTimeout
+	bool            StreamPreconfigure();
+	// next StreamPreconfigure() reprograms everything, not just changed settings
+	void            invalidate_preconfigure(){  FPreconfigured = false;  }
 	bool            StartStreaming();
     void            StopStreaming();
 
@@ -162,6 +233,7 @@ public:
 	void            set_ReferenceClockSource(int ref_clk_s);
 	void            set_SampleClockSource(int sample_clk_s);
 	void            set_ExternalTrigger(int ext_trig);
+	void            set_TriggerPeriod(double period);
 	void            set_AdcRate(double rate);
 	void            set_DacRate(double rate);
 	void            set_AdcFrameSize(int size);
@@ -169,10 +241,38 @@ public:
 	void            set_AdcRepeats(int repeats);
 	void            set_AdcActiveChannel(vector<int> active_channels);
 	void            set_DacActiveChannel(vector<int> active_channels);
+	void            set_DacCalibration(int channel, double gain, double offset);
+	void            set_DacIqSkew(int device, double skew);
+	void            set_DacCalibrated(bool enable);
+	void            set_DacClipPolicy(int policy);
+	void            set_DacAutoScale(int mode);
+	void            set_PatternPingPong(bool enable, unsigned int pong_addr);
+	void            set_DacUploadChunking(int chunk_words, int in_flight);
+	void            set_PllLockTimeout(double timeout_ms);
+	void            set_TriggerAlerts(bool enable);
+	// settings profiles, identified by a hash of the configuration they hold
+	bool            save_settings(const std::string & path);
+	bool            load_settings(const std::string & path);
+	uint64_t        settings_hash() const;
+	bool            settings_applied() const;
 
     bool            IsStreaming(){  return Timer.Enabled();  }
-	void            write_wishbone_register(int baseAddr, int offset, int data);
-	int        read_wishbone_register(int baseAddr, int offset) const;
+	void            write_wishbone_register(uint32_t baseAddr, uint32_t offset, uint32_t data);
+	uint32_t        read_wishbone_register(uint32_t baseAddr, uint32_t offset) const;
+	// batches: ops rows are (base, offset, value), addrs rows are (base, offset)
+	void            write_wishbone_batch(const uint32_t * ops, int rows, int cols);
+	void            read_wishbone_batch(const uint32_t * addrs, int rows, int cols,
+	                                    uint32_t ** values, int * count);
+	// shadowed config registers skip redundant writes and read from the shadow
+	void            set_wishbone_cached(uint32_t baseAddr, uint32_t offset, bool cached);
+	void            invalidate_wishbone_shadow();
+	vector<double>  wishbone_shadow_stats();
+	// register programs are parsed once, then run without a call per register;
+	// unloading frees the handle for the next load
+	int             load_register_program(const std::string & text);
+	bool            unload_register_program(int program);
+	bool            run_register_program(int program);
+	vector<double>  register_program_trace();
     void            WriteRom();
     void            ReadRom();
     unsigned int     OutputChannels() const {  return 4;  }
@@ -181,12 +281,31 @@ public:
 	// settings and waveform builder
 	ApplicationSettings             Settings;
 	Innovative::ArbWaveBuilder     Builder;
+	Innovative::PatternSequence    Sequence;
+	Innovative::PatternDoneQueue   PatternDone;    // replay futures and callbacks
 
-	// ADC data and DAC wavedata
-	vector<int>            adc_data_;
+	// ADC data and DAC wavedata; the capture holds samples only, VITA headers
+	// dropped, ordered (repeats, channels, FrameSize)
 	vector<int>            read_adc_data();
+	// moves the capture out without copying: read_adc_data() is empty after it
+	void                   read_adc_array(short ** data, int * repeats, int * channels, int * samples);
 	vector<double>         wavedata_;
 	void                   write_dac_wavedata(vector<double> wavedata);
+	// contiguous numpy arrays, read in place; int16 holds DAC codes, not quantized
+	void                   write_dac_array(const double * wave, int length);
+	void                   write_dac_array_f32(const float * wave, int length);
+	void                   write_dac_codes(const short * codes, int length);
+	vector<short>          wavecodes_;      // write_dac_codes() waveform
+	// DAC waveform as segments, expanded to DAC codes only when built
+	Innovative::WaveSegmentArray  wavesegments_;
+	void                   clear_dac_segments();
+	void                   add_dac_constant(int length, vector<double> level);
+	void                   add_dac_ramp(int length, vector<double> start, vector<double> stop);
+	void                   add_dac_samples(vector<double> wavedata);
+	void                   add_dac_repeat(int span, int count);
+	void                   write_dac_segments();
+	vector<double>         dac_wave_stats();
+	vector<double>         dac_upload_timings();
 
     void    DacTestStatus()
 	{
@@ -201,12 +320,53 @@ public:
 
     float   Temperature();
     bool    PllLocked();
+    //  Last relock in ms from clock programming through Stream.Preconfigure()
+    //  to lock, -1 if it timed out; rates in MHz as programmed, no hardware query
+    double  pll_lock_time(){  return FPllLockTime;  }
+    double  adc_rate_actual(){  return FAdcRateActual;  }
+    double  dac_rate_actual(){  return FDacRateActual;  }
     bool    DacInternalCal();
+    //  Background sampling of the three above; reads never touch the hardware
+    bool    start_health_monitor(double interval_ms);
+    void    stop_health_monitor();
+    vector<double>  health_latest();
+    vector<double>  health_history(double window_s);
+    int     health_skipped(){  return static_cast<int>(Health.Skipped());  }
+    //  Alerts since reset_alerts(), kinds in Innovative::AlertLog::AlertKind order
+    vector<double>  alert_counts();
+    vector<double>  alert_log();
+    int     alert_log_dropped();
+    void    reset_alerts();
     //
     void	EnterPatternMode();
     void	LeavePatternMode();
     void	PatternLoadCommand();
+    //  Build and upload on a worker; the calling thread returns at once
+    bool	pattern_load_async();
+    bool	pattern_load_pending();
+    double	pattern_load_progress(){  return FLoadProgress;  }
+    void	cancel_pattern_load(){  FLoadCancel = true;  }
+    bool	wait_pattern_load(double timeout_ms);
+    bool	pattern_load_result();
+#ifndef SWIG
+    std::shared_future<bool>  PatternLoadFuture() const {  return FLoadTask;  }
+    //  One future per replay sent, completed by its pattern-done alert;
+    //  replays are registered here, never call PatternDone.Expect() as well
+    std::vector<Innovative::PatternDoneQueue::DoneFuture>  PatternReplayCommand();
+#else
     void	PatternReplayCommand();
+#endif
+    int 	pattern_region(){  return FPatternRegion;  }
+    //  Replay completion, from pattern-done alerts
+    int 	pattern_done_count();
+    int 	pattern_replays_pending();
+    bool	wait_pattern_done(double timeout_ms);
+    bool	wait_pattern_count(int count, double timeout_ms);
+    //  Sequence of pattern blocks, identical blocks loaded once
+    void	clear_sequence();
+    int 	add_sequence_block(string label, vector<double> wavedata);
+    bool	add_sequence_step(string label, int repeats);
+    void	SequenceLoadCommand();
     //
     unsigned int  PatternSize();
     void	BufferTransmit(/*const Innovative::Buffer & Packet*/);
@@ -216,6 +376,8 @@ public:
     ///////////////////
     //Board Information
     ///////////////////
+    //All of the below, read once at Open
+    BoardInfo   board_info() const {  return FBoardInfo;  }
     //Logic Version
     std::string FpgaLogicVersion();
     //Hardware Variant
@@ -245,12 +407,108 @@ private:
     Innovative::TriggerManager      Trig;
 	Innovative::SoftwareTimer       Timer;
     Innovative::StopWatch           RunTimeSW;
-	Innovative::VeloBuffer          WaveformPacket;
+	Innovative::TriggerScheduler    TrigTrain;
+	Innovative::TriggerLog          TrigLog;
+	Innovative::ReplayQueue         Replays;
+	Innovative::HealthMonitor       Health;
+	Innovative::AlertLog            AlertEvents;
 	// App State Variables
 	bool                            FOpened;
 	bool                            FStreamConnected;
+	bool                            FPreconfigured;     // FApplied matches the hardware
+	ApplicationSettings             FApplied;           // as of the last StreamPreconfigure()
+	uint64_t                        FAppliedHash;       // AppliedHash(FApplied)
+	std::string                     FWarmProfile;       // open_warm() profile, state saved beside it
+	uint32_t                        FWarmTokenBase;     // scratch register holding FWarmToken
+	uint32_t                        FWarmTokenOffset;
+	uint32_t                        FWarmToken;         // 0 while the board state is unproven
+	bool                            FStreamPreconfigured;   // Stream.Preconfigure() ran in this process
+	BoardInfo                       FBoardInfo;
+	// FrequencyActual() per (clock source, reference source, reference MHz, rate MHz)
+	typedef std::tuple<int, int, double, double>  ClockKey;
+	std::map<ClockKey, double>      FAdcActual;
+	std::map<ClockKey, double>      FDacActual;
+	double                          FAdcRateActual;
+	double                          FDacRateActual;
+	double                          FPllLockTime;
 	bool                            Stopped;
 	int                             PrefillPacketCount;
+	std::vector<Innovative::PatternSequence::Step>  FSequenceSteps;   // empty unless a sequence is loaded
+	std::atomic<int>                FPatternRegion;     // region the replays point at
+	std::shared_future<bool>        FLoadTask;          // pattern_load_async() worker
+	std::atomic<double>             FLoadProgress;
+	std::atomic<bool>               FLoadCancel;
+	std::atomic<bool>               FLoadUploaded;      // worker done, database not yet updated
+	std::atomic<bool>               FLoadJoining;       // a caller holding FCallLock waits for the worker
+	int                             FLoadRegion;        // where the worker loads, for PublishPatternLoad()
+	unsigned int                    FLoadAddr;
+	unsigned int                    FLoadSize;
+	//  Info packet fields of a load, taken from Settings when it is started
+	struct PatternInfo
+	{
+		std::vector<unsigned int>   Sids;
+		std::vector<char>           Tags;
+		unsigned int                RepCount;
+		int                         Mode;           // IPatternModeSystem::PatternRepeatType
+	};
+	PatternInfo                     FLoadInfo;          // the worker's, with FLoadClipPolicy
+	int                             FLoadClipPolicy;
+	// Blocking calls run without the GIL, so Python threads may overlap them
+	std::recursive_mutex            FCallLock;
+	// A load's info packet and its data go out back to back, never split by a replay
+	std::mutex                      FPatternStreamLock;
+	// Wishbone bus spaces per base address, and the register shadow. The
+	// logic memory space they sit on lives from Open() until after they go
+	typedef std::map<uint32_t, Innovative::WishboneBusSpace> WishboneSpaceMap;
+	mutable std::mutex              FWishboneLock;
+	mutable std::unique_ptr<Innovative::LogicMemorySpace>  FLogicMemory;
+	mutable WishboneSpaceMap        FWishboneSpaces;
+	mutable Innovative::RegisterShadow  FShadow;
+	std::vector<Innovative::RegisterProgram>        FPrograms;        // no ops in a free slot
+	std::vector<Innovative::RegisterProgram::Trace> FProgramTrace;   // last run_register_program()
+	// ADC capture, malloc'd so read_adc_array() can pass ownership to numpy
+	std::mutex                      FCaptureLock;
+	short                          *FCapture;
+	size_t                          FCaptureSize;
+	size_t                          FCaptureCapacity;
+	size_t                          FCaptureChannels;   // active Rx channels of the run
+	size_t                          FCaptureSamples;    // Rx.FrameSize of the run
+
+	void  PatternStreamIds(std::vector<unsigned int> & sids, std::vector<char> & tags);
+	bool  LoadPattern(const std::string & label, unsigned int addr);
+	void  SendPattern(const std::string & label, unsigned int addr, unsigned int size_in_words);
+	void  UploadPattern(unsigned int addr, unsigned int size_in_words, const PatternInfo & info);
+	void  GetPatternInfo(PatternInfo & info);
+	bool  PatternLoadTask();
+	void  PublishPatternLoad();
+	void  WaitPatternLoad();
+	void  ReleaseCapture();
+	void  HaltStreaming();
+	Innovative::WishboneBusSpace &  WishboneSpace(uint32_t baseAddr) const;
+	bool  OpenBoard(int target, const std::string & profile,
+	                uint32_t token_base, uint32_t token_offset);
+	void  WriteWarmToken(uint32_t token);
+	uint32_t  ReadWarmToken();
+	void  InvalidateBoardState();
+	std::string  BoardStatePath() const;
+	uint64_t  AppliedHash(const ApplicationSettings & s) const;
+	std::string  FirmwareId();
+	void  ReadBoardInfo();
+	void  SaveBoardState();
+	bool  BoardStateMatches();
+	void  ConfigureModule(bool tx_channels, bool rx_channels, bool routing,
+	                      bool adc_clock, bool dac_clock);
+	bool  WaitPllLock(std::chrono::steady_clock::time_point start);
+	size_t  FramedWaveSize(size_t samples);
+	void  SetWaveSize(size_t samples);
+	int   NextPatternRegion();
+	bool  PatternRegionFits(int region, unsigned int size_in_words);
+	bool  BuildWaveform();
+	void  PrepareWaveform();
+	bool  QuantizeWaveform(int clip_policy);
+	void  UploadWaveform();
+	Innovative::ReplayQueue::CommandList  ProgramReplays();
+	Innovative::PatternDoneQueue::DoneFuture  SendReplay(const Innovative::ReplayQueue::Command & cmd);
 
 protected:
     void  HandleDataAvailable(Innovative::VitaPacketStreamDataEvent & Event);
@@ -0,0 +1,75 @@
+// This is the cpp file for the alert counters and event log of x6_1000m api
+
+// alert_log.cpp
+
+
+#include "alert_log.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS AlertLog
+	//==============================================================================
+
+	AlertLog::AlertLog(unsigned int capacity)
+		: FRing(capacity), FEpoch(0)
+	{
+		Reset();
+	}
+
+	//------------------------------------------------------------------------------
+	//  AlertLog::Reset() -- Zero the counters and start a new log from now
+	//------------------------------------------------------------------------------
+
+	void AlertLog::Reset()
+	{
+		FEpoch = Clock::now().time_since_epoch().count();
+		FRing.Reset();
+		for (int i = 0; i < akCount; i++)
+			FCounts[i] = 0;
+	}
+
+	//------------------------------------------------------------------------------
+	//  AlertLog::Push() -- Count an alert and log it, safe from any thread
+	//------------------------------------------------------------------------------
+
+	void AlertLog::Push(int kind, unsigned int argument, double board_time)
+	{
+		if (kind < 0 || kind >= akCount)
+			return;
+		Clock::time_point now = Clock::now();
+		FCounts[kind].fetch_add(1, std::memory_order_relaxed);
+
+		Record rec;
+		Clock::duration since = now.time_since_epoch() - Clock::duration(FEpoch.load());
+		rec.Time = std::chrono::duration<double>(since).count();
+		rec.BoardTime = board_time;
+		rec.Argument = argument;
+		rec.Kind = kind;
+		FRing.Push(rec);
+	}
+
+	//------------------------------------------------------------------------------
+	//  AlertLog::Counts() -- Alerts of each kind since Reset(), by AlertKind
+	//------------------------------------------------------------------------------
+
+	void AlertLog::Counts(std::vector<unsigned long long> & counts) const
+	{
+		counts.resize(akCount);
+		for (int i = 0; i < akCount; i++)
+			counts[i] = FCounts[i].load(std::memory_order_relaxed);
+	}
+
+	//------------------------------------------------------------------------------
+	//  AlertLog::Snapshot() -- Copy out the records logged since Reset()
+	//------------------------------------------------------------------------------
+
+	size_t AlertLog::Snapshot(std::vector<Record> & records) const
+	{
+		return FRing.Snapshot(records);
+	}
+
+} // namespace Innovative
@@ -0,0 +1,67 @@
+// This is the header file for the alert counters and event log of x6_1000m api
+
+// alert_log.h
+
+#ifndef alert_logH
+#define alert_logH
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include "seq_ring.h"
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS AlertLog -- Per-alert counters and a bounded log of alert events
+	//==============================================================================
+	//  Push() is wait-free so it can run inside the alert handlers: one atomic
+	//  increment and one SeqRing push. When the ring wraps the oldest records
+	//  are lost, the counters are not.
+
+	class AlertLog
+	{
+	public:
+		typedef std::chrono::steady_clock  Clock;
+
+		enum AlertKind
+		{
+			akTimestampRollover, akSoftware, akWarningTemperature,
+			akInputOverflow, akOutputUnderflow, akTrigger,
+			akInputOverrange, akOutputOverrange, akPatternDone,
+			akCount
+		};
+
+		struct Record
+		{
+			double          Time;           // host seconds since Reset()
+			double          BoardTime;      // alert timestamp from the board, seconds
+			unsigned int    Argument;       // alert specific, e.g. channel mask
+			int             Kind;           // AlertKind
+		};
+
+		explicit AlertLog(unsigned int capacity = 0x1000);
+
+		//  Methods
+		void    Reset();
+		void    Push(int kind, unsigned int argument, double board_time);
+		void    Counts(std::vector<unsigned long long> & counts) const;
+		size_t  Snapshot(std::vector<Record> & records) const;   // returns records lost
+
+	private:
+		//
+		//  Member Data
+		SeqRing<Record>                     FRing;
+		std::atomic<long long>              FEpoch;     // Clock ticks at Reset()
+		std::atomic<unsigned long long>     FCounts[akCount];
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
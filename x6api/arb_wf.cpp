@@ -8,23 +8,64 @@
 #include <sstream>
 #include <fstream>
 #include <limits>
+#include <cmath>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include "arb_wf.h"
 #include <IppCharDG_Mb.h>
 #include <Poco/Random.h>
 
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define ARB_WF_SSE2
+#include <emmintrin.h>
+#endif
+
 using namespace std;
 
 namespace Innovative
 {
 
+	//------------------------------------------------------------------------
+	// SegmentEvents() -- Number of events a segment list expands to
+	//------------------------------------------------------------------------
+
+	size_t SegmentEvents(const WaveSegmentArray & segments)
+	{
+		std::vector<size_t> begin(segments.size(), 0);
+		size_t events = 0;
+		for (size_t s = 0; s < segments.size(); ++s)
+		{
+			const WaveSegment & seg = segments[s];
+			begin[s] = events;
+			if (seg.Type == WaveSegment::stRepeat)
+			{
+				size_t span = (std::min)(static_cast<size_t>(seg.Span), s);
+				size_t block = span ? events - begin[s - span] : 0;
+				events += block * seg.Length;
+			}
+			else
+				events += seg.Length;
+		}
+		return events;
+	}
+
 	//=============================================================================
 	//  CLASS ArbWaveform  --  Endpoint-disciplined waveform generator
 	//=============================================================================
 
 	ArbWaveform::ArbWaveform()
-		: FBits(16),
-		FChannels(1), Generator(new Poco::Random)
+		: FSamples(0), FBits(16),
+		FChannels(1), FFirst(0), FStride(1), FIqSkew(0.), FIqA(1.), FIqB(0.),
+		FCodeLo(0.), FCodeHi(0.), Generator(new Poco::Random)
 	{
+		FCal.resize(FChannels);
+		FNorm.assign(FChannels, 1.);
+		UpdateCoefficients();
 	}
 
 	ArbWaveform::~ArbWaveform()
@@ -41,14 +82,74 @@ namespace Innovative
 		FSamples = samples;
 		FChannels = channels;
 		FBits = bits;
+		FFirst = 0;
+		FStride = FChannels;
 
-		DoubleDG Waveform(Data);
-
-		Waveform.Resize(FSamples*FChannels);
-		Zero();
+		FCal.resize(FChannels);
+		FNorm.assign(FChannels, 1.);
+		UpdateCoefficients();
 		Generator->seed();
 	}
 
+	//------------------------------------------------------------------------
+	// ArbWaveform::Interleave() -- Locate this device's channels in wavedata
+	//------------------------------------------------------------------------
+
+	void ArbWaveform::Interleave(int first, int stride)
+	{
+		FFirst = first;
+		FStride = stride;
+	}
+
+	//------------------------------------------------------------------------
+	// ArbWaveform::Calibration() -- Per-channel gain/offset and IQ skew
+	//------------------------------------------------------------------------
+	//  cal points at FChannels entries. iq_skew is the phase error in radians
+	//  between channel 0 (I) and channel 1 (Q); zero disables the correction.
+
+	void ArbWaveform::Calibration(const DacChannelCal * cal, double iq_skew)
+	{
+		for (unsigned int ch = 0; ch < FChannels; ++ch)
+			FCal[ch] = cal ? cal[ch] : DacChannelCal();
+		FIqSkew = (FChannels >= 2) ? iq_skew : 0.;
+		UpdateCoefficients();
+	}
+
+	//------------------------------------------------------------------------
+	// ArbWaveform::Normalization() -- Per-channel auto-scale factors
+	//------------------------------------------------------------------------
+	//  norm points at FChannels entries, folded into the cached code scale
+	//  so normalizing costs nothing in the quantization pass.
+
+	void ArbWaveform::Normalization(const double * norm)
+	{
+		for (unsigned int ch = 0; ch < FChannels; ++ch)
+			FNorm[ch] = norm ? norm[ch] : 1.;
+		UpdateCoefficients();
+	}
+
+	//------------------------------------------------------------------------
+	// ArbWaveform::UpdateCoefficients() -- Cache per-channel scale factors
+	//------------------------------------------------------------------------
+
+	void ArbWaveform::UpdateCoefficients()
+	{
+		// Amplitude.
+		double FScale = (1 << (FBits - 1)) - 1;
+		double A = FScale * 0.95;
+
+		FCodeScale.resize(FChannels);
+		for (unsigned int ch = 0; ch < FChannels; ++ch)
+			FCodeScale[ch] = A * FCal[ch].Gain * FNorm[ch];
+
+		//  Q' = Q/cos(skew) - I*tan(skew) undoes a Q lagging I by skew
+		FIqA = 1. / std::cos(FIqSkew);
+		FIqB = -std::tan(FIqSkew);
+
+		FCodeLo = -FScale - 1.;
+		FCodeHi = FScale;
+	}
+
 	//------------------------------------------------------------------------
 	// ArbWaveform::Resize()
 	//------------------------------------------------------------------------
@@ -64,145 +165,388 @@ namespace Innovative
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Zero()
+	// ArbWaveform::Quantize() -- Scale, calibrate and convert to DAC codes
 	//------------------------------------------------------------------------
 
-	void ArbWaveform::Zero(int ch)
+	bool ArbWaveform::Quantize(Buffer & data)
 	{
-		DoubleDG Waveform(Data);
+		FStats.assign(FChannels, DacChannelStats());
 
-		for (unsigned int n = 0; n < FSamples; ++n)
-			Waveform[n*FChannels + ch] = 0.;
+		if (!segments.empty())
+		{
+			if (!SegmentsValid())
+				return false;
+			if (FBits <= 8)
+				QuantizeSegments<char>(data);
+			else if (FBits <= 16)
+				QuantizeSegments<short>(data);
+			else
+				QuantizeSegments<int>(data);
+			return true;
+		}
+
+		if (!codes.empty())
+		{
+			if (codes.size() < static_cast<size_t>(FSamples) * FStride)
+				return false;
+			if (FBits <= 8)
+				CopyCodes<char>(data);
+			else if (FBits <= 16)
+				CopyCodes<short>(data);
+			else
+				CopyCodes<int>(data);
+			return true;
+		}
+
+		if (wavedata.size() < static_cast<size_t>(FSamples) * FStride)
+			return false;
+
+		if (FBits <= 8)
+			QuantizeTo<char>(data);
+		else if (FBits <= 16 && FChannels == 2)
+			QuantizePairs(data);
+		else if (FBits <= 16)
+			QuantizeTo<short>(data);
+		else
+			QuantizeTo<int>(data);
+		return true;
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Zero()
+	// ArbWaveform::QuantizeFrame() -- Convert one event of this device
 	//------------------------------------------------------------------------
+	//  frame points at this device's first channel. The frame stands for
+	//  weight events starting at event, which only matters for clip counts.
+	//  Out of range values are saturated rather than left to wrap.
 
-	void ArbWaveform::Zero()
+	template <typename T>
+	inline void ArbWaveform::QuantizeFrame(const double * frame, AccessDatagram<T> & dg, size_t idx,
+		size_t event, size_t weight)
 	{
 		for (unsigned int ch = 0; ch < FChannels; ++ch)
-			Zero(ch);
+		{
+			double v = frame[ch];
+			if (ch == 1 && FIqSkew != 0.)
+				v = FIqA*v + FIqB*frame[0];
+			v = v*FCodeScale[ch] + FCal[ch].Offset;
+
+			DacChannelStats & st = FStats[ch];
+			if (v < st.Min)
+				st.Min = v;
+			if (v > st.Max)
+				st.Max = v;
+			if (v <= FCodeLo - 1. || v >= FCodeHi + 1.)
+			{
+				if (!st.Clipped)
+					st.FirstClip = event;
+				st.Clipped += weight;
+				v = (v < 0.) ? FCodeLo : FCodeHi;
+			}
+			dg[idx + ch] = static_cast<T>(v);
+		}
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Apply() -- Copy data out to buffer
+	// ArbWaveform::QuantizeTo() -- Single pass from wavedata to packed codes
 	//------------------------------------------------------------------------
 
-	void ArbWaveform::Apply(Buffer & data)
+	template <typename T>
+	void ArbWaveform::QuantizeTo(Buffer & data)
 	{
-		for (unsigned int ch = 0; ch < FChannels; ++ch)
-		{
-			Copy(data, ch);
-		}
+		AccessDatagram<T> dg(data);
+
+		size_t src = FFirst;
+		size_t idx = 0;
+		for (unsigned int n = 0; n < FSamples; ++n, src += FStride, idx += FChannels)
+			QuantizeFrame(&wavedata[src], dg, idx, n, 1);
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Accumulate_ch()
+	// ArbWaveform::CopyCodes() -- Pack ready-made DAC codes, no scaling
 	//------------------------------------------------------------------------
+	//  Calibration and normalization are the caller's business here. Codes
+	//  outside the DAC's range are counted and saturated like quantized
+	//  values, so a narrower device never wraps them.
 
-	bool ArbWaveform::Accumulate_ch(size_t deviceid, int ch)
+	template <typename T>
+	void ArbWaveform::CopyCodes(Buffer & data)
 	{
-		DoubleDG Waveform(Data);
+		AccessDatagram<T> dg(data);
 
-		// Amplitude.
-		double FScale = (1 << (FBits - 1)) - 1;
-		double A = FScale * 0.95;
-
-		int start = deviceid + ch;
-		int step = 2*FChannels;
-		for (unsigned int n = 0; n < FSamples; ++n)
+		size_t src = FFirst;
+		size_t idx = 0;
+		for (unsigned int n = 0; n < FSamples; ++n, src += FStride, idx += FChannels)
 		{
-			double sample = A*wavedata[n*step + start];
-			Waveform[n*FChannels + ch] += sample;
+			for (unsigned int ch = 0; ch < FChannels; ++ch)
+			{
+				short c = codes[src + ch];
+				DacChannelStats & st = FStats[ch];
+				if (c < st.Min)
+					st.Min = c;
+				if (c > st.Max)
+					st.Max = c;
+				if (c < FCodeLo || c > FCodeHi)
+				{
+					if (!st.Clipped)
+						st.FirstClip = n;
+					st.Clipped++;
+					c = static_cast<short>(c < 0 ? FCodeLo : FCodeHi);
+				}
+				dg[idx + ch] = static_cast<T>(c);
+			}
 		}
-		//Normalize(ch);
-		return true;
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Accumulate()
+	// ArbWaveform::QuantizePairs() -- SSE2 QuantizeTo<short> for I/Q devices
 	//------------------------------------------------------------------------
+	//  Both channels of an event sit side by side in wavedata, so one vector
+	//  carries an event through calibration, range tracking and saturation.
 
-	bool ArbWaveform::Accumulate(size_t deviceid)
+	void ArbWaveform::QuantizePairs(Buffer & data)
 	{
-		bool result = true;
-		for (unsigned int ch = 0; ch < FChannels; ++ch)
-			result &= Accumulate_ch(deviceid, ch);
+#ifdef ARB_WF_SSE2
+		ShortDG dg(data);
+
+		const __m128d scale = _mm_set_pd(FCodeScale[1], FCodeScale[0]);
+		const __m128d offset = _mm_set_pd(FCal[1].Offset, FCal[0].Offset);
+		const __m128d iq_a = _mm_set_pd(FIqA, 1.);
+		const __m128d iq_b = _mm_set_pd(FIqB, 0.);
+		const __m128d clip_lo = _mm_set1_pd(FCodeLo - 1.);
+		const __m128d clip_hi = _mm_set1_pd(FCodeHi + 1.);
+		const __m128d code_lo = _mm_set1_pd(FCodeLo);
+		const __m128d code_hi = _mm_set1_pd(FCodeHi);
+		const bool iq = (FIqSkew != 0.);
+
+		__m128d vmin = _mm_set1_pd(FStats[0].Min);
+		__m128d vmax = _mm_set1_pd(FStats[0].Max);
+
+		const double * src = &wavedata[FFirst];
+		size_t idx = 0;
+		for (unsigned int n = 0; n < FSamples; ++n, src += FStride, idx += 2)
+		{
+			__m128d v = _mm_loadu_pd(src);
+			if (iq)
+				v = _mm_add_pd(_mm_mul_pd(v, iq_a), _mm_mul_pd(_mm_unpacklo_pd(v, v), iq_b));
+			v = _mm_add_pd(_mm_mul_pd(v, scale), offset);
 
-		return result;
+			vmin = _mm_min_pd(vmin, v);
+			vmax = _mm_max_pd(vmax, v);
+
+			int clip = _mm_movemask_pd(_mm_or_pd(_mm_cmple_pd(v, clip_lo), _mm_cmpge_pd(v, clip_hi)));
+			if (clip)
+			{
+				for (unsigned int ch = 0; ch < 2; ++ch)
+				{
+					if (!(clip & (1 << ch)))
+						continue;
+					if (!FStats[ch].Clipped)
+						FStats[ch].FirstClip = n;
+					FStats[ch].Clipped++;
+				}
+				v = _mm_min_pd(_mm_max_pd(v, code_lo), code_hi);
+			}
+
+			__m128i codes = _mm_cvttpd_epi32(v);
+			dg[idx] = static_cast<short>(_mm_cvtsi128_si32(codes));
+			dg[idx + 1] = static_cast<short>(_mm_cvtsi128_si32(_mm_srli_si128(codes, 4)));
+		}
+
+		double lo[2], hi[2];
+		_mm_storeu_pd(lo, vmin);
+		_mm_storeu_pd(hi, vmax);
+		for (unsigned int ch = 0; ch < 2; ++ch)
+		{
+			FStats[ch].Min = lo[ch];
+			FStats[ch].Max = hi[ch];
+		}
+#else
+		QuantizeTo<short>(data);
+#endif
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Copy()
+	// ArbWaveform::SegmentsValid() -- Check segment frames match the stride
 	//------------------------------------------------------------------------
 
-	void ArbWaveform::Copy(Buffer & data, int ch)
+	bool ArbWaveform::SegmentsValid() const
 	{
-		DoubleDG Waveform(Data);
-		// Samples per buffer.
-
-		if (FBits <= 8)
+		for (size_t s = 0; s < segments.size(); ++s)
 		{
-			CharDG dg(data);
-			// Populate buffer.
-			for (unsigned int n = 0; n < FSamples; ++n)
+			const WaveSegment & seg = segments[s];
+			switch (seg.Type)
 			{
-				int idx = n*FChannels + ch;
-				char v = static_cast<char>(Waveform[idx]);
-				dg[idx] = v;
+			case WaveSegment::stConstant:
+				if (seg.Start.size() != FStride)
+					return false;
+				break;
+			case WaveSegment::stRamp:
+				if (seg.Start.size() != FStride || seg.Stop.size() != FStride)
+					return false;
+				break;
+			case WaveSegment::stSampled:
+				if (seg.Samples.size() < static_cast<size_t>(seg.Length) * FStride)
+					return false;
+				break;
+			case WaveSegment::stRepeat:
+				break;
+			default:
+				return false;
 			}
 		}
-		else if (FBits <= 16)
+		return true;
+	}
+
+	//------------------------------------------------------------------------
+	// ArbWaveform::QuantizeSegments() -- Expand segments straight to codes
+	//------------------------------------------------------------------------
+	//  Constant runs are quantized once and replicated, repeats copy codes
+	//  already produced, so only ramps and sampled runs cost a conversion
+	//  per event. Output beyond the segments is padded with a zero level.
+
+	template <typename T>
+	void ArbWaveform::QuantizeSegments(Buffer & data)
+	{
+		AccessDatagram<T> dg(data);
+
+		const size_t total = static_cast<size_t>(FSamples) * FChannels;
+		std::vector<size_t> begin(segments.size(), 0);
+		std::vector<size_t> clipped(segments.size() * FChannels, 0);
+		std::vector<double> frame(FChannels, 0.);
+
+		size_t idx = 0;
+		for (size_t s = 0; s < segments.size() && idx < total; ++s)
 		{
-			ShortDG dg(data);
-			// Populate buffer.
-			for (unsigned int n = 0; n < FSamples; ++n)
+			const WaveSegment & seg = segments[s];
+			begin[s] = idx;
+			for (unsigned int ch = 0; ch < FChannels; ++ch)
+				clipped[s*FChannels + ch] = FStats[ch].Clipped;
+			switch (seg.Type)
+			{
+			case WaveSegment::stConstant:
+				if (seg.Length)
+				{
+					size_t end = (std::min)(total, idx + static_cast<size_t>(seg.Length) * FChannels);
+					QuantizeFrame(&seg.Start[FFirst], dg, idx, idx / FChannels, (end - idx) / FChannels);
+					for (size_t i = idx + FChannels; i < end; ++i)
+						dg[i] = dg[i - FChannels];
+					idx = end;
+				}
+				break;
+
+			case WaveSegment::stRamp:
+				for (unsigned int n = 0; n < seg.Length && idx < total; ++n, idx += FChannels)
+				{
+					double t = static_cast<double>(n) / seg.Length;
+					for (unsigned int ch = 0; ch < FChannels; ++ch)
+					{
+						double a = seg.Start[FFirst + ch];
+						frame[ch] = a + t*(seg.Stop[FFirst + ch] - a);
+					}
+					QuantizeFrame(&frame[0], dg, idx, idx / FChannels, 1);
+				}
+				break;
+
+			case WaveSegment::stSampled:
+				for (unsigned int n = 0; n < seg.Length && idx < total; ++n, idx += FChannels)
+					QuantizeFrame(&seg.Samples[n*FStride + FFirst], dg, idx, idx / FChannels, 1);
+				break;
+
+			case WaveSegment::stRepeat:
 			{
-				int idx = n*FChannels + ch;
-				short v = static_cast<short>(Waveform[idx]);
-				dg[idx] = v;
+				size_t span = (std::min)(static_cast<size_t>(seg.Span), s);
+				size_t from = span ? begin[s - span] : idx;
+				size_t block = idx - from;
+				for (unsigned int r = 0; r < seg.Length && block && idx < total; ++r)
+				{
+					//  the replayed codes clip wherever the originals did
+					for (unsigned int ch = 0; ch < FChannels && span; ++ch)
+						FStats[ch].Clipped += clipped[s*FChannels + ch] - clipped[(s - span)*FChannels + ch];
+					for (size_t i = 0; i < block && idx < total; ++i, ++idx)
+						dg[idx] = dg[from + i];
+				}
+				break;
+			}
 			}
 		}
-		else
+
+		if (idx < total)
 		{
-			IntegerDG dg(data);
-			// Populate buffer.
-			for (unsigned int n = 0; n < FSamples; ++n)
-			{
-				int idx = n*FChannels + ch;
-				int v = static_cast<int>(Waveform[idx]);
-				dg[idx] = v;
-			}
+			std::fill(frame.begin(), frame.end(), 0.);
+			QuantizeFrame(&frame[0], dg, idx, idx / FChannels, (total - idx) / FChannels);
+			for (size_t i = idx + FChannels; i < total; ++i)
+				dg[i] = dg[i - FChannels];
 		}
 	}
 
 	//------------------------------------------------------------------------
-	// ArbWaveform::Normalize()
+	// SegmentMaxAbs() -- Fold interleaved segment values into result
 	//------------------------------------------------------------------------
 
-	bool ArbWaveform::Normalize(int ch)
+	static void SegmentMaxAbs(const std::vector<double> & values, size_t n, std::vector<double> & result)
 	{
-		DoubleDG Waveform(Data);
+		size_t stride = result.size();
+		for (size_t i = 0; i < n && stride; ++i)
+			result[i % stride] = (std::max)(result[i % stride], std::fabs(values[i]));
+	}
+
+	//------------------------------------------------------------------------
+	// ArbWaveform::MaxAbs() -- Peak magnitude of each wavedata channel
+	//------------------------------------------------------------------------
+	//  result gets FStride entries, one per interleaved channel. Sampled data
+	//  is reduced with SSE2 two channels at a time; segments only need their
+	//  levels and ramp end points.
 
-		// Add waveform elements
-		double maximum = (std::numeric_limits<double>::min)();
-		for (unsigned int n = 0; n < FSamples; ++n)
+	void ArbWaveform::MaxAbs(std::vector<double> & result) const
+	{
+		result.assign(FStride, 0.);
+
+		if (!segments.empty())
 		{
-			int idx = n*FChannels + ch;
-			maximum = (std::max)(Waveform[idx], maximum);
+			for (size_t s = 0; s < segments.size(); ++s)
+			{
+				const WaveSegment & seg = segments[s];
+				switch (seg.Type)
+				{
+				case WaveSegment::stRamp:
+					SegmentMaxAbs(seg.Stop, seg.Stop.size(), result);
+					// fall through
+				case WaveSegment::stConstant:
+					SegmentMaxAbs(seg.Start, seg.Start.size(), result);
+					break;
+				case WaveSegment::stSampled:
+					SegmentMaxAbs(seg.Samples, (std::min)(seg.Samples.size(),
+						static_cast<size_t>(seg.Length) * FStride), result);
+					break;
+				}
+			}
+			return;
 		}
 
-		// Normalize
-		double A = ((1 << (FBits - 1)) - 1) * 0.95;
-		double scale = A / maximum;
-		for (unsigned int n = 0; n < FSamples; ++n)
+		size_t events = (std::min)(static_cast<size_t>(FSamples), FStride ? wavedata.size() / FStride : 0);
+		const double * src = wavedata.empty() ? 0 : &wavedata[0];
+
+#ifdef ARB_WF_SSE2
+		if (FStride % 2 == 0 && FStride <= 8)
 		{
-			int idx = n*FChannels + ch;
-			Waveform[idx] *= scale;
+			const __m128d sign = _mm_set1_pd(-0.);
+			__m128d acc[4];
+			for (unsigned int c = 0; c < 4; ++c)
+				acc[c] = _mm_setzero_pd();
+
+			unsigned int pairs = FStride / 2;
+			for (size_t n = 0; n < events; ++n, src += FStride)
+				for (unsigned int c = 0; c < pairs; ++c)
+					acc[c] = _mm_max_pd(acc[c], _mm_andnot_pd(sign, _mm_loadu_pd(src + 2*c)));
+
+			for (unsigned int c = 0; c < pairs; ++c)
+				_mm_storeu_pd(&result[2*c], acc[c]);
+			return;
 		}
-
-		return true;
+#endif
+		for (size_t n = 0; n < events; ++n, src += FStride)
+			for (unsigned int c = 0; c < FStride; ++c)
+				result[c] = (std::max)(result[c], std::fabs(src[c]));
 	}
 
 	//==============================================================================
@@ -227,11 +571,7 @@ namespace Innovative
 
 	bool  WaveGenerator::SingleWave(size_t deviceid, Buffer & data)
 	{
-		Gen.Zero();
-		bool rtn = Gen.Accumulate(deviceid);
-		if (rtn)
-			Gen.Apply(data);
-		return rtn;
+		return Gen.Quantize(data);
 	}
 
 	//==============================================================================
@@ -241,16 +581,147 @@ namespace Innovative
 	//  ArbWaveBuilder::BuildWave() -- Fill Buffer(s) with a waveform
 	//------------------------------------------------------------------------------
 
-	void ArbWaveBuilder::BuildWave(VeloBuffer & Buffer)
+	bool ArbWaveBuilder::BuildWave(VeloBuffer & Buffer)
 	{
-		//  Fill scratch buffers
-		CreateScratchBuffers();
-
-		//  Fill scratch buffers
-		GenerateWave();
+		if (!Quantize())
+			return false;
 
 		//  Create Output Playback Buffer
 		FillOutputWaveBuffer(Buffer);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::Quantize() -- Fill the scratch buffers with DAC codes
+	//------------------------------------------------------------------------------
+
+	bool ArbWaveBuilder::Quantize()
+	{
+		CreateScratchBuffers();
+		return GenerateWave();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::Packetize() -- Hand the quantized wave to send in chunks
+	//------------------------------------------------------------------------------
+	//  The calling thread packs chunk k+1 while a sender thread runs send on
+	//  chunk k; at most MaxInFlight chunks are packed and not yet sent, which
+	//  bounds memory to that many chunks rather than the whole waveform. The
+	//  first exception from send or from packing stops both threads and is
+	//  rethrown here once the sender has been joined.
+
+	void  ArbWaveBuilder::Packetize(const ChunkEvent & send)
+	{
+		typedef std::chrono::steady_clock Clock;
+		FTimings.clear();
+		size_t words = Scratch.empty() ? 0 : Scratch[0].SizeInInts();
+		if (!words)
+			return;
+		size_t chunk = (FChunkWords && FChunkWords < words) ? FChunkWords : words;
+		size_t chunks = (words + chunk - 1) / chunk;
+		FTimings.resize(chunks);
+
+		struct Packed
+		{
+			VeloBuffer  Data;
+			size_t      Index;
+			double      Sent;
+		};
+		std::deque<Packed> queue;
+		size_t pending = 0;             // packing, queued or being sent
+		bool finished = false;
+		bool complete = false;
+		std::exception_ptr error;
+		std::mutex lock;
+		std::condition_variable changed;
+
+		std::thread sender([&]
+			{
+				std::unique_lock<std::mutex> guard(lock);
+				for (;;)
+				{
+					changed.wait(guard, [&] {  return finished || !queue.empty();  });
+					if (queue.empty())
+						break;
+					Packed item = queue.front();
+					queue.pop_front();
+					guard.unlock();
+					try
+					{
+						Clock::time_point t0 = Clock::now();
+						send(item.Data, item.Sent);
+						FTimings[item.Index].Send = std::chrono::duration<double>(Clock::now() - t0).count();
+					}
+					catch (...)
+					{
+						guard.lock();
+						error = std::current_exception();
+						queue.clear();
+						changed.notify_all();
+						break;
+					}
+					guard.lock();
+					pending--;
+					changed.notify_all();
+				}
+			});
+
+		//  Joins the sender on every way out; unsent chunks are dropped unless
+		//  every chunk was packed
+		struct Finish
+		{
+			std::mutex &               Lock;
+			std::condition_variable &  Changed;
+			std::thread &              Sender;
+			std::deque<Packed> &       Queue;
+			bool &                     Finished;
+			bool &                     Complete;
+
+			~Finish()
+			{
+				{
+					std::lock_guard<std::mutex> guard(Lock);
+					Finished = true;
+					if (!Complete)
+						Queue.clear();
+				}
+				Changed.notify_all();
+				Sender.join();
+			}
+		};
+
+		{
+			Finish finish = { lock, changed, sender, queue, finished, complete };
+			size_t packet = 0;
+			for (size_t i = 0; i < chunks; i++)
+			{
+				{
+					std::unique_lock<std::mutex> guard(lock);
+					changed.wait(guard, [&] {  return pending < FMaxInFlight || error;  });
+					if (error)
+						break;
+					pending++;
+				}
+				size_t offset = i*chunk;
+				size_t size = (std::min)(chunk, words - offset);
+				Clock::time_point t0 = Clock::now();
+				Packed item;
+				PackChunk(offset, size, packet, item.Data);
+				item.Index = i;
+				item.Sent = static_cast<double>(offset + size) / words;
+				FTimings[i].Words = size * Scratch.size();
+				FTimings[i].Pack = std::chrono::duration<double>(Clock::now() - t0).count();
+				FTimings[i].Send = 0.;
+				{
+					std::lock_guard<std::mutex> guard(lock);
+					queue.push_back(item);
+				}
+				changed.notify_all();
+			}
+			complete = true;
+		}
+		if (error)
+			std::rethrow_exception(error);
 	}
 
 	//------------------------------------------------------------------------------
@@ -274,15 +745,42 @@ namespace Innovative
 	//  ArbWaveBuilder::GenerateWave() --
 	//------------------------------------------------------------------------------
 
-	void  ArbWaveBuilder::GenerateWave()
+	bool  ArbWaveBuilder::GenerateWave()
 	{
 		size_t devices = FDeviceSids.size();
 		size_t channels = (devices) ? FChannels / devices : FChannels;
+		bool result = true;
+		FStats.clear();
+
+		//  Auto-scale peak magnitude to full scale, per channel or jointly
+		std::vector<double> norm;
+		if (FAutoScale != asNone && WaveGen.Gen.codes.empty())
+		{
+			WaveGen.Gen.Format((int)FChannels, FBits, FSamples);
+			WaveGen.Gen.MaxAbs(norm);
+			double joint = 0.;
+			for (size_t ch = 0; ch < norm.size(); ch++)
+				joint = (std::max)(joint, norm[ch]);
+			for (size_t ch = 0; ch < norm.size(); ch++)
+			{
+				double peak = (FAutoScale == asJoint) ? joint : norm[ch];
+				norm[ch] = (peak > 0.) ? 1. / peak : 1.;
+			}
+		}
+
 		for (size_t i = 0; i<devices; i++)
 		{
+			size_t first = i*channels;
 			WaveGen.Gen.Format((int)channels, FBits, FSamples);
-			WaveGen.SingleWave(i, Scratch[i]);   //  One Wave on all channels
+			WaveGen.Gen.Interleave((int)first, FChannels);
+			WaveGen.Gen.Calibration(
+				(FCal.size() >= first + channels) ? &FCal[first] : 0,
+				(FIqSkew.size() > i) ? FIqSkew[i] : 0.);
+			WaveGen.Gen.Normalization(norm.empty() ? 0 : &norm[first]);
+			result &= WaveGen.SingleWave(i, Scratch[i]);   //  One Wave on all channels
+			FStats.insert(FStats.end(), WaveGen.Gen.Stats().begin(), WaveGen.Gen.Stats().end());
 		}
+		return result;
 	}
 
 	//------------------------------------------------------------------------------
@@ -290,11 +788,22 @@ namespace Innovative
 	//------------------------------------------------------------------------------
 
 	void  ArbWaveBuilder::FillOutputWaveBuffer(VeloBuffer & OutputWaveform)
+	{
+		size_t packet = 0;
+		PackChunk(0, Scratch[0].SizeInInts(), packet, OutputWaveform);
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::PackChunk() -- Pack words at offset of each scratch buffer
+	//------------------------------------------------------------------------------
+	//  packet carries the VITA packet count on to the next chunk.
+
+	void  ArbWaveBuilder::PackChunk(size_t offset, size_t words, size_t & packet, VeloBuffer & chunk)
 	{
 		//  We now have the data in an array of scratch buffers.
 		//     We need to copy it into VITA packets, and then pack those VITAs
 		//     into the outbound Waveform packet
-		size_t words_remaining = Scratch[0].SizeInInts();
+		size_t words_remaining = words;
 		//
 		//  Use a packer to load full VITA packets into a velo packet
 		//  ...Make the packer output size so big, we will not fill it before finishing
@@ -302,8 +811,6 @@ namespace Innovative
 		VPPk.OnDataAvailable.SetEvent(this, &ArbWaveBuilder::HandlePackedDataAvailable);
 		//
 		//  Bust up the scratch buffer into VITA packets
-		size_t offset = 0;
-		size_t packet = 0;
 		size_t MaxVitaSize = 0x100000;
 		while (words_remaining)
 		{
@@ -349,7 +856,7 @@ namespace Innovative
 
 									  // WaveformPacket is now correctly filled with data...
 
-		OutputWaveform = WaveformPacket;   // "return" the waveform
+		chunk = WaveformPacket;   // "return" the waveform
 
 	}
 	//---------------------------------------------------------------------------
@@ -383,12 +890,71 @@ namespace Innovative
 		return scratch_pkt_size;
 	}
 
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::Clipped() -- Events saturated on any channel by the last build
+	//------------------------------------------------------------------------------
+
+	size_t ArbWaveBuilder::Clipped() const
+	{
+		size_t clipped = 0;
+		for (size_t ch = 0; ch < FStats.size(); ch++)
+			clipped += FStats[ch].Clipped;
+		return clipped;
+	}
+
 	//------------------------------------------------------------------------------
 	//  ArbWaveBuilder::set_wavedata() --
 	//------------------------------------------------------------------------------
 	void ArbWaveBuilder::set_wavedata(vector<double> wavedata)
 	{
 		WaveGen.Gen.wavedata = wavedata;
+		WaveGen.Gen.segments.clear();
+		WaveGen.Gen.codes.clear();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::set_segments() -- Segments are expanded in BuildWave()
+	//------------------------------------------------------------------------------
+	void ArbWaveBuilder::set_segments(const WaveSegmentArray & segments)
+	{
+		WaveGen.Gen.segments = segments;
+		WaveGen.Gen.wavedata.clear();
+		WaveGen.Gen.codes.clear();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::set_codes() -- DAC codes, interleaved like wavedata
+	//------------------------------------------------------------------------------
+	void ArbWaveBuilder::set_codes(const std::vector<short> & codes)
+	{
+		WaveGen.Gen.codes = codes;
+		WaveGen.Gen.wavedata.clear();
+		WaveGen.Gen.segments.clear();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::set_calibration() -- Cache DAC corrections per channel
+	//------------------------------------------------------------------------------
+	void ArbWaveBuilder::set_calibration(const std::vector<float> & gain,
+		const std::vector<float> & offset, const std::vector<float> & iq_skew)
+	{
+		size_t channels = (std::min)(gain.size(), offset.size());
+		FCal.resize(channels);
+		for (size_t ch = 0; ch < channels; ch++)
+		{
+			FCal[ch].Gain = gain[ch];
+			FCal[ch].Offset = offset[ch];
+		}
+		FIqSkew.assign(iq_skew.begin(), iq_skew.end());
+	}
+
+	//------------------------------------------------------------------------------
+	//  ArbWaveBuilder::clear_calibration() -- Revert to nominal gain and offset
+	//------------------------------------------------------------------------------
+	void ArbWaveBuilder::clear_calibration()
+	{
+		FCal.clear();
+		FIqSkew.clear();
 	}
 
 
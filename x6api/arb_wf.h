@@ -10,6 +10,8 @@
 #include <Buffer_Mb.h>
 #include <BufferDatagrams_Mb.h>
 #include <VitaPacketStream_Mb.h>
+#include <limits>
+#include <functional>
 
 
 // Forward declaration
@@ -22,6 +24,67 @@ namespace Innovative
 #ifdef __CLR_VER
 #pragma managed(push, off)
 #endif
+	//==============================================================================
+	//  STRUCT DacChannelCal -- Per-channel DAC correction coefficients
+	//==============================================================================
+
+	struct DacChannelCal
+	{
+		double      Gain;       // multiplicative gain correction, 1.0 is nominal
+		double      Offset;     // additive offset correction in DAC codes
+
+		DacChannelCal()
+			: Gain(1.0), Offset(0.0)
+			{}
+	};
+
+	//==============================================================================
+	//  STRUCT WaveSegment -- Run-length description of part of a waveform
+	//==============================================================================
+	//  Values are frames holding one entry per wavedata channel, interleaved
+	//  the same way as ArbWaveform::wavedata.
+
+	struct WaveSegment
+	{
+		enum SegmentType { stConstant, stRamp, stSampled, stRepeat };
+
+		int                  Type;
+		unsigned int         Length;     // events; repetitions for stRepeat
+		unsigned int         Span;       // preceding segments replayed by stRepeat
+		std::vector<double>  Start;      // level (stConstant), first frame (stRamp)
+		std::vector<double>  Stop;       // frame reached at the end of stRamp
+		std::vector<double>  Samples;    // interleaved frames (stSampled)
+
+		WaveSegment()
+			: Type(stConstant), Length(0), Span(0)
+			{}
+	};
+
+	typedef std::vector<WaveSegment> WaveSegmentArray;
+
+	//==============================================================================
+	//  STRUCT DacChannelStats -- Range and clipping seen while quantizing
+	//==============================================================================
+
+	struct DacChannelStats
+	{
+		double      Min;            // smallest value, in DAC codes before saturation
+		double      Max;            // largest value, in DAC codes before saturation
+		size_t      Clipped;        // events saturated to the code range
+		long long   FirstClip;      // event index of the first clip, -1 if none
+
+		DacChannelStats()
+			: Min((std::numeric_limits<double>::max)()),
+			Max(-(std::numeric_limits<double>::max)()),
+			Clipped(0), FirstClip(-1)
+			{}
+	};
+
+	enum DacClipPolicy { cpSaturate, cpReject, cpWarn };
+	enum DacAutoScale { asNone, asPerChannel, asJoint };
+
+	size_t  SegmentEvents(const WaveSegmentArray & segments);
+
 	//==============================================================================
 	//  CLASS  ArbWaveform
 	//==============================================================================
@@ -29,7 +92,9 @@ namespace Innovative
 	class ArbWaveform
 	{
 	public:
-		vector<double> wavedata;
+		vector<double>    wavedata;
+		WaveSegmentArray  segments;     // used instead of wavedata when not empty
+		std::vector<short>  codes;      // DAC codes sent as they are, instead of wavedata
 
 		// Ctor
 		ArbWaveform();
@@ -37,25 +102,50 @@ namespace Innovative
 
 		// Methods
 		void        Format(int channels, int bits, int samples);
+		void        Interleave(int first, int stride);
+		void        Calibration(const DacChannelCal * cal, double iq_skew);
+		void        Normalization(const double * norm);
+		void        MaxAbs(std::vector<double> & result) const;
 		void        Resize(Buffer & data);
-		void        Zero(int ch);
-		void        Zero();
-		bool        Accumulate_ch(size_t deviceid, int ch);
-		bool        Accumulate(size_t deviceid);
-		void        Apply(Buffer & data);
+		bool        Quantize(Buffer & data);
+		const std::vector<DacChannelStats> & Stats() const {  return FStats;  }
 
 	protected:
 		// Fields
 		unsigned int    FSamples;
 		unsigned int    FBits;
 		unsigned int    FChannels;
+		unsigned int    FFirst;         // first wavedata channel of this device
+		unsigned int    FStride;        // wavedata channels per sample
+
+		// Calibration, cached per channel as code = v*Scale + Offset
+		std::vector<DacChannelCal>  FCal;
+		std::vector<double>         FCodeScale;
+		std::vector<double>         FNorm;
+		double          FIqSkew;
+		double          FIqA;
+		double          FIqB;
+		double          FCodeLo;        // representable code range
+		double          FCodeHi;
+
+		// Validation, gathered by the quantizer
+		std::vector<DacChannelStats>  FStats;
 
 		// Data
 		Poco::Random   *Generator;
-		Buffer          Data;
 
-		bool Normalize(int ch);
-		void Copy(Buffer & data, int ch);
+		void UpdateCoefficients();
+		bool SegmentsValid() const;
+		template <typename T>
+		void QuantizeFrame(const double * frame, AccessDatagram<T> & dg, size_t idx,
+			size_t event, size_t weight);
+		void QuantizePairs(Buffer & data);
+		template <typename T>
+		void QuantizeTo(Buffer & data);
+		template <typename T>
+		void QuantizeSegments(Buffer & data);
+		template <typename T>
+		void CopyCodes(Buffer & data);
 	//private:
 	//	// No copy or assignment
 	//	ArbWaveform(const ArbWaveform &);
@@ -82,9 +172,25 @@ namespace Innovative
 	class ArbWaveBuilder
 	{
 	public:
-		ArbWaveBuilder(){}
+		typedef std::function<void(VeloBuffer &, double)>  ChunkEvent;   // chunk, fraction sent
+
+		struct ChunkTiming
+		{
+			size_t      Words;          // payload of all devices
+			double      Pack;           // seconds to pack into VITA packets
+			double      Send;           // seconds spent in the send event
+		};
+
+		ArbWaveBuilder()
+			: FAutoScale(asNone), FChunkWords(0), FMaxInFlight(2)
+			{}
 
 		void set_wavedata(vector<double> wavedata);
+		void set_segments(const WaveSegmentArray & segments);
+		void set_codes(const std::vector<short> & codes);
+		void set_calibration(const std::vector<float> & gain, const std::vector<float> & offset,
+			const std::vector<float> & iq_skew);
+		void clear_calibration();
 		//
 		//  Properties
 		void Format(const std::vector<int> & device_sids, int channels, int bits, int samples)
@@ -96,7 +202,15 @@ namespace Innovative
 		}
 		//
 		//  Methods
-		void  BuildWave(VeloBuffer & Buffer);
+		bool  BuildWave(VeloBuffer & Buffer);
+		bool  Quantize();
+		void  Packetize(const ChunkEvent & send);
+		void  AutoScale(int mode) {  FAutoScale = mode;  }
+		void  ChunkSize(size_t words) {  FChunkWords = words;  }
+		void  MaxInFlight(unsigned int chunks) {  FMaxInFlight = chunks ? chunks : 1;  }
+		const std::vector<ChunkTiming> & ChunkTimings() const {  return FTimings;  }
+		const std::vector<DacChannelStats> & Stats() const {  return FStats;  }
+		size_t  Clipped() const;
 
 	private:
 		//
@@ -106,14 +220,22 @@ namespace Innovative
 		unsigned int            FBits;
 		unsigned int            FChannels;
 		std::vector<int>        FDeviceSids;
+		std::vector<DacChannelCal>  FCal;
+		std::vector<double>         FIqSkew;
+		std::vector<DacChannelStats>  FStats;
+		int                     FAutoScale;
+		size_t                  FChunkWords;    // per device, 0 packs the whole wave
+		unsigned int            FMaxInFlight;
+		std::vector<ChunkTiming>  FTimings;
 
 		WaveGenerator    WaveGen;
 		std::vector<Buffer>  Scratch;
 		VeloBuffer           WaveformPacket;
 
 		void    CreateScratchBuffers();
-		void    GenerateWave();
+		bool    GenerateWave();
 		void    FillOutputWaveBuffer(VeloBuffer & OutputWaveform);
+		void    PackChunk(size_t offset, size_t words, size_t & packet, VeloBuffer & chunk);
 
 		size_t  CalculateScratchBufferSize();
 
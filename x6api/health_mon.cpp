@@ -0,0 +1,125 @@
+// This is the cpp file for the background health monitor of x6_1000m api
+
+// health_mon.cpp
+
+
+#include "health_mon.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS HealthMonitor
+	//==============================================================================
+
+	HealthMonitor::HealthMonitor(unsigned int capacity)
+		: FInterval(1.), FRing(capacity), FSkipped(0), FRunning(false), FStop(false)
+	{
+	}
+
+	HealthMonitor::~HealthMonitor()
+	{
+		Stop();
+	}
+
+	//------------------------------------------------------------------------------
+	//  HealthMonitor::Start() -- Begin a new history, sampling every Interval()
+	//------------------------------------------------------------------------------
+
+	bool HealthMonitor::Start()
+	{
+		Stop();
+		if (!FSample || FInterval <= 0.)
+			return false;
+
+		FRing.Reset();
+		FSkipped = 0;
+		FStop = false;
+		FRunning = true;
+		FThread = std::thread(&HealthMonitor::Execute, this);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  HealthMonitor::Stop() -- Wake the sampler and wait for it to exit
+	//------------------------------------------------------------------------------
+	//  The history stays readable until the next Start().
+
+	void HealthMonitor::Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(FStopLock);
+			FStop = true;
+		}
+		FStopEvent.notify_all();
+		if (FThread.joinable())
+			FThread.join();
+		FRunning = false;
+	}
+
+	//------------------------------------------------------------------------------
+	//  HealthMonitor::Latest() -- Most recent sample, false before the first
+	//------------------------------------------------------------------------------
+
+	bool HealthMonitor::Latest(Sample & sample) const
+	{
+		return FRing.Latest(sample);
+	}
+
+	//------------------------------------------------------------------------------
+	//  HealthMonitor::History() -- Samples of the last window seconds, oldest first
+	//------------------------------------------------------------------------------
+
+	void HealthMonitor::History(double window, std::vector<Sample> & samples) const
+	{
+		std::vector<Sample> all;
+		FRing.Snapshot(all);
+
+		samples.clear();
+		if (all.empty())
+			return;
+		const double last = all.back().Time;
+		for (size_t i = 0; i < all.size(); i++)
+			if (last - all[i].Time <= window)
+				samples.push_back(all[i]);
+	}
+
+	//------------------------------------------------------------------------------
+	//  HealthMonitor::Execute() -- Sampler thread body
+	//------------------------------------------------------------------------------
+	//  Waits on the stop event between samples, so Stop() returns at once.
+
+	void HealthMonitor::Execute()
+	{
+		const Clock::time_point t0 = Clock::now();
+		const Clock::duration interval =
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FInterval));
+		Clock::time_point deadline = t0;
+
+		std::unique_lock<std::mutex> lock(FStopLock);
+		while (!FStop)
+		{
+			lock.unlock();
+			Sample sample = Sample();
+			if (FSample(sample))
+			{
+				sample.Time = std::chrono::duration<double>(Clock::now() - t0).count();
+
+				FRing.Push(sample);
+			}
+			else
+				FSkipped++;
+
+			// fixed rate; a slow read skips ahead rather than bursting
+			deadline += interval;
+			Clock::time_point now = Clock::now();
+			if (deadline < now)
+				deadline = now + interval;
+			lock.lock();
+			FStopEvent.wait_until(lock, deadline, [this] {  return FStop;  });
+		}
+	}
+
+} // namespace Innovative
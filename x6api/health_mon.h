@@ -0,0 +1,81 @@
+// This is the header file for the background health monitor of x6_1000m api
+
+// health_mon.h
+
+#ifndef health_monH
+#define health_monH
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "seq_ring.h"
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS HealthMonitor -- Samples board health on its own thread
+	//==============================================================================
+	//  The sampler pushes into a SeqRing, so readers copy the latest value or a
+	//  history window without locking and without touching the hardware.
+
+	class HealthMonitor
+	{
+	public:
+		typedef std::chrono::steady_clock  Clock;
+
+		struct Sample
+		{
+			double      Time;           // seconds since Start()
+			float       Temperature;    // logic temperature, degrees C
+			bool        PllLocked;
+			bool        DacCalOk;       // DAC internal calibration status
+		};
+
+		typedef std::function<bool(Sample &)>  SampleEvent;    // fills in the readings, false skips
+
+		explicit HealthMonitor(unsigned int capacity = 0x1000);
+		~HealthMonitor();
+
+		//  Properties
+		void    OnSample(const SampleEvent & sample) {  FSample = sample;  }
+		void    Interval(double seconds) {  FInterval = seconds;  }
+		double  Interval() const {  return FInterval;  }
+		bool    Running() const {  return FRunning;  }
+		unsigned long long  Count() const {  return FRing.Count();  }
+		unsigned long long  Skipped() const {  return FSkipped;  }
+
+		//  Methods
+		bool    Start();
+		void    Stop();
+		bool    Latest(Sample & sample) const;
+		void    History(double window, std::vector<Sample> & samples) const;
+
+	private:
+		//
+		//  Member Data
+		SampleEvent                         FSample;
+		double                              FInterval;
+		SeqRing<Sample>                     FRing;      // reset at Start()
+		std::atomic<unsigned long long>     FSkipped;   // samples declined by the event
+		std::atomic<bool>                   FRunning;
+		bool                                FStop;
+		std::mutex                          FStopLock;
+		std::condition_variable             FStopEvent;
+		std::thread                         FThread;
+
+		void    Execute();
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
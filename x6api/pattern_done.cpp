@@ -0,0 +1,114 @@
+// This is the cpp file for pattern completion events of x6_1000m api
+
+// pattern_done.cpp
+
+
+#include <chrono>
+#include "pattern_done.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS PatternDoneQueue
+	//==============================================================================
+	//------------------------------------------------------------------------------
+	//  PatternDoneQueue::Expect() -- Register a replay, future of its completion
+	//------------------------------------------------------------------------------
+	//  The future yields the completed count once the board reports it done.
+
+	PatternDoneQueue::DoneFuture PatternDoneQueue::Expect()
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		FPending.push_back(std::promise<Counter>());
+		FIssued++;
+		return FPending.back().get_future().share();
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternDoneQueue::Done() -- Pattern-done alert
+	//------------------------------------------------------------------------------
+	//  Callbacks run on the alert thread, outside the lock.
+
+	void PatternDoneQueue::Done()
+	{
+		Counter count;
+		std::vector<DoneEvent> callbacks;
+		{
+			std::lock_guard<std::mutex> lock(FLock);
+			count = ++FDone;
+			if (!FPending.empty())
+			{
+				FPending.front().set_value(count);
+				FPending.pop_front();
+			}
+			callbacks = FCallbacks;
+		}
+		FChanged.notify_all();
+
+		for (size_t i = 0; i < callbacks.size(); i++)
+			callbacks[i](count);
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternDoneQueue::Reset() -- Restart counting, abandon outstanding replays
+	//------------------------------------------------------------------------------
+	//  Futures of abandoned replays report std::future_errc::broken_promise.
+
+	void PatternDoneQueue::Reset()
+	{
+		{
+			std::lock_guard<std::mutex> lock(FLock);
+			FPending.clear();
+			FIssued = 0;
+			FDone = 0;
+		}
+		FChanged.notify_all();
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternDoneQueue::WaitFor() -- Block until count completions, timeout s
+	//------------------------------------------------------------------------------
+
+	bool PatternDoneQueue::WaitFor(Counter count, double timeout)
+	{
+		std::unique_lock<std::mutex> lock(FLock);
+		return FChanged.wait_for(lock, std::chrono::duration<double>(timeout),
+			[&] {  return FDone >= count;  });
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternDoneQueue::OnDone() -- Add a completion callback
+	//------------------------------------------------------------------------------
+
+	void PatternDoneQueue::OnDone(const DoneEvent & event)
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		FCallbacks.push_back(event);
+	}
+
+	void PatternDoneQueue::ClearCallbacks()
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		FCallbacks.clear();
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternDoneQueue::Issued(), Completed() --
+	//------------------------------------------------------------------------------
+
+	PatternDoneQueue::Counter PatternDoneQueue::Issued() const
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		return FIssued;
+	}
+
+	PatternDoneQueue::Counter PatternDoneQueue::Completed() const
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		return FDone;
+	}
+
+} // namespace Innovative
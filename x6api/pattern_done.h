@@ -0,0 +1,67 @@
+// This is the header file for pattern completion events of x6_1000m api
+
+// pattern_done.h
+
+#ifndef pattern_doneH
+#define pattern_doneH
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <vector>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS PatternDoneQueue -- Turn pattern-done alerts into completion events
+	//==============================================================================
+	//  Every replay sent to the board calls Expect(); every pattern-done alert
+	//  calls Done(), which completes the oldest outstanding replay, bumps the
+	//  counter and fires the callbacks with the new count. Only the code that
+	//  sends a replay may call Expect(), or the futures pair with the wrong alerts.
+
+	class PatternDoneQueue
+	{
+	public:
+		typedef unsigned long long                      Counter;
+		typedef std::function<void(Counter)>            DoneEvent;
+		typedef std::shared_future<Counter>             DoneFuture;
+
+		PatternDoneQueue()
+			: FIssued(0), FDone(0)
+			{}
+
+		//  Methods
+		DoneFuture  Expect();
+		void        Done();
+		void        Reset();
+		bool        WaitFor(Counter count, double timeout);
+		void        OnDone(const DoneEvent & event);
+		void        ClearCallbacks();
+
+		//  Properties
+		Counter     Issued() const;
+		Counter     Completed() const;
+
+	private:
+		//
+		//  Member Data
+		mutable std::mutex                  FLock;
+		std::condition_variable             FChanged;
+		std::deque<std::promise<Counter> >  FPending;
+		std::vector<DoneEvent>              FCallbacks;
+		Counter                             FIssued;
+		Counter                             FDone;
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
@@ -0,0 +1,164 @@
+// This is the cpp file for pattern sequence compiling of x6_1000m api
+
+// pattern_seq.cpp
+
+
+#include "pattern_seq.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS PatternSequence
+	//==============================================================================
+	//------------------------------------------------------------------------------
+	//  PatternSequence::Clear() --
+	//------------------------------------------------------------------------------
+
+	void PatternSequence::Clear()
+	{
+		FBlocks.clear();
+		FLabels.clear();
+		FRequested.clear();
+		FPatterns.clear();
+		FSteps.clear();
+		FCompiled = false;
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternSequence::AddBlock() -- Register content, sharing identical blocks
+	//------------------------------------------------------------------------------
+	//  Takes the contents of wavedata. Returns the index of the block the label
+	//  now refers to.
+
+	size_t PatternSequence::AddBlock(const std::string & label, std::vector<double> & wavedata)
+	{
+		unsigned long long hash = Hash(wavedata);
+		FCompiled = false;
+
+		for (size_t i = 0; i < FBlocks.size(); i++)
+		{
+			if (FBlocks[i].Hash == hash && FBlocks[i].wavedata == wavedata)
+			{
+				FLabels[label] = i;
+				return i;
+			}
+		}
+
+		Block block;
+		block.Label = label;
+		block.wavedata.swap(wavedata);
+		block.Hash = hash;
+		block.Used = false;
+		block.Addr = 0;
+		block.SizeInWords = 0;
+		block.Samples = 0;
+		FBlocks.push_back(block);
+
+		FLabels[label] = FBlocks.size() - 1;
+		return FBlocks.size() - 1;
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternSequence::AddStep() -- Append a block played repeats times
+	//------------------------------------------------------------------------------
+
+	bool PatternSequence::AddStep(const std::string & label, unsigned int repeats)
+	{
+		std::map<std::string, size_t>::const_iterator it = FLabels.find(label);
+		if (it == FLabels.end())
+			return false;
+		if (!repeats)
+			return true;
+
+		Step step;
+		step.Pattern = it->second;
+		step.RepCount = repeats;
+		FRequested.push_back(step);
+		FCompiled = false;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternSequence::Compile() -- Lay out used blocks and merge their runs
+	//------------------------------------------------------------------------------
+	//  Blocks are padded to the trigger frame granularity and placed back to
+	//  back in pattern memory from base_addr, in order of first use. The stored
+	//  wavedata stays as added, so Hash keeps describing it; Samples is the
+	//  padded length to load.
+
+	void PatternSequence::Compile(unsigned int base_addr, unsigned int channels, unsigned int framesize)
+	{
+		FPatterns.clear();
+		FSteps.clear();
+
+		std::vector<size_t> pattern_of(FBlocks.size(), 0);
+		for (size_t i = 0; i < FBlocks.size(); i++)
+			FBlocks[i].Used = false;
+
+		unsigned int addr = base_addr;
+		for (size_t i = 0; i < FRequested.size(); i++)
+		{
+			Block & block = FBlocks[FRequested[i].Pattern];
+			if (!block.Used)
+			{
+				size_t res = framesize ? block.wavedata.size() % framesize : 0;
+				block.Samples = block.wavedata.size() + (res ? framesize - res : 0);
+
+				size_t events = channels ? block.Samples / channels : 0;
+				block.Used = true;
+				block.Addr = addr;
+				block.SizeInWords = static_cast<unsigned int>(events * channels * sizeof(short) / sizeof(int));
+				addr += block.SizeInWords;
+
+				pattern_of[FRequested[i].Pattern] = FPatterns.size();
+				FPatterns.push_back(FRequested[i].Pattern);
+			}
+
+			size_t pattern = pattern_of[FRequested[i].Pattern];
+			if (!FSteps.empty() && FSteps.back().Pattern == pattern)
+				FSteps.back().RepCount += FRequested[i].RepCount;
+			else
+			{
+				Step step;
+				step.Pattern = pattern;
+				step.RepCount = FRequested[i].RepCount;
+				FSteps.push_back(step);
+			}
+		}
+
+		FCompiled = true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternSequence::SizeInWords() -- Pattern memory used by the sequence
+	//------------------------------------------------------------------------------
+
+	unsigned int PatternSequence::SizeInWords() const
+	{
+		unsigned int words = 0;
+		for (size_t i = 0; i < FPatterns.size(); i++)
+			words += FBlocks[FPatterns[i]].SizeInWords;
+		return words;
+	}
+
+	//------------------------------------------------------------------------------
+	//  PatternSequence::Hash() -- FNV-1a over the sample bytes
+	//------------------------------------------------------------------------------
+
+	unsigned long long PatternSequence::Hash(const std::vector<double> & data)
+	{
+		unsigned long long hash = 14695981039346656037ULL;
+		const unsigned char * p = data.empty() ? 0 : reinterpret_cast<const unsigned char *>(&data[0]);
+		size_t bytes = data.size() * sizeof(double);
+		for (size_t i = 0; i < bytes; i++)
+		{
+			hash ^= p[i];
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+} // namespace Innovative
@@ -0,0 +1,78 @@
+// This is the header file for pattern sequence compiling of x6_1000m api
+
+// pattern_seq.h
+
+#ifndef pattern_seqH
+#define pattern_seqH
+
+#include <string>
+#include <vector>
+#include <map>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS PatternSequence -- Map a long sequence onto reusable pattern blocks
+	//==============================================================================
+	//  Blocks with identical content share one copy in pattern memory, and runs
+	//  of the same block collapse into a single replay with a larger RepCount.
+
+	class PatternSequence
+	{
+	public:
+		struct Block
+		{
+			std::string          Label;
+			std::vector<double>  wavedata;
+			unsigned long long   Hash;
+			bool                 Used;           // referenced by a step
+			unsigned int         Addr;           // pattern memory address
+			unsigned int         SizeInWords;
+			size_t               Samples;        // wavedata padded to the frame size
+		};
+
+		struct Step
+		{
+			size_t          Pattern;         // index into Patterns()
+			unsigned int    RepCount;
+		};
+
+		PatternSequence()
+			: FCompiled(false)
+			{}
+
+		//  Methods
+		void    Clear();
+		size_t  AddBlock(const std::string & label, std::vector<double> & wavedata);
+		bool    AddStep(const std::string & label, unsigned int repeats);
+		void    Compile(unsigned int base_addr, unsigned int channels, unsigned int framesize);
+
+		//  Properties
+		bool                         Compiled() const {  return FCompiled;  }
+		const std::vector<Block> &   Blocks() const {  return FBlocks;  }
+		const std::vector<size_t> &  Patterns() const {  return FPatterns;  }
+		const std::vector<Step> &    Steps() const {  return FSteps;  }
+		unsigned int                 SizeInWords() const;
+
+	private:
+		//
+		//  Member Data
+		std::vector<Block>             FBlocks;
+		std::map<std::string, size_t>  FLabels;
+		std::vector<Step>              FRequested;     // Pattern holds a block index
+		std::vector<size_t>            FPatterns;      // used blocks, in load order
+		std::vector<Step>              FSteps;
+		bool                           FCompiled;
+
+		static unsigned long long  Hash(const std::vector<double> & data);
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
@@ -0,0 +1,197 @@
+// This is the cpp file for wishbone register programs of x6_1000m api
+
+// reg_prog.cpp
+
+
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include <thread>
+#include <cerrno>
+#include <cstdlib>
+#include "reg_prog.h"
+
+using namespace std;
+
+namespace Innovative
+{
+	//------------------------------------------------------------------------
+	// ParseNumber() -- One unsigned operand in C notation
+	//------------------------------------------------------------------------
+	//  strtoull() would take "-1" as its two's complement, so any sign is
+	//  refused, as is a value past 64 bits.
+
+	static bool ParseNumber(const std::string & token, unsigned long long & value)
+	{
+		if (token.empty() || token[0] == '-' || token[0] == '+')
+			return false;
+		char * end = 0;
+		errno = 0;
+		value = std::strtoull(token.c_str(), &end, 0);
+		return *end == '\0' && errno != ERANGE;
+	}
+
+	//==============================================================================
+	//  CLASS RegisterProgram
+	//==============================================================================
+	//------------------------------------------------------------------------------
+	//  RegisterProgram::Parse() -- Compile the text, error names the first bad line
+	//------------------------------------------------------------------------------
+
+	bool RegisterProgram::Parse(const std::string & text, std::string & error)
+	{
+		std::vector<Op> ops;
+		std::istringstream lines(text);
+		std::string line;
+		for (int number = 1; std::getline(lines, line); number++)
+		{
+			std::string::size_type comment = line.find('#');
+			if (comment != std::string::npos)
+				line.erase(comment);
+
+			std::istringstream words(line);
+			std::string code;
+			if (!(words >> code))
+				continue;
+
+			std::vector<unsigned long long> args;
+			std::string token;
+			unsigned long long value;
+			bool valid = true;
+			while (words >> token)
+			{
+				valid &= ParseNumber(token, value);
+				args.push_back(value);
+			}
+
+			Op op = Op();
+			op.Line = number;
+			size_t expected = 0;
+			if (code == "w")
+			{
+				op.Code = opWrite;
+				expected = 3;
+			}
+			else if (code == "m")
+			{
+				op.Code = opModify;
+				expected = 4;
+			}
+			else if (code == "p")
+			{
+				op.Code = opPoll;
+				expected = 5;
+			}
+			else if (code == "d")
+			{
+				op.Code = opDelay;
+				expected = 1;
+			}
+
+			//  register operands are 32 bit; only times may be wider
+			size_t registers = (op.Code == opDelay) ? 0 : (std::min)(expected, size_t(4));
+			for (size_t i = 0; i < registers && i < args.size(); i++)
+				valid &= args[i] <= 0xFFFFFFFFull;
+
+			if (!expected || !valid || args.size() != expected)
+			{
+				std::ostringstream msg;
+				msg << "line " << number << ": cannot parse \"" << line << "\"";
+				error = msg.str();
+				return false;
+			}
+
+			if (op.Code == opDelay)
+				op.Time = args[0] * 1e-6;
+			else
+			{
+				op.Base = static_cast<uint32_t>(args[0]);
+				op.Offset = static_cast<uint32_t>(args[1]);
+				op.Value = static_cast<uint32_t>(args[expected == 3 ? 2 : 3]);
+				op.Mask = (expected == 3) ? 0xFFFFFFFF : static_cast<uint32_t>(args[2]);
+				if (op.Code == opPoll)
+					op.Time = args[4] * 1e-6;
+			}
+			ops.push_back(op);
+		}
+		FOps.swap(ops);
+		error.clear();
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  RegisterProgram::Run() -- Execute through read/write, tracing each step
+	//------------------------------------------------------------------------------
+	//  Delays sleep when long and spin on the monotonic clock when short, so
+	//  microsecond delays are not rounded up to a tick. Polls re-read back to
+	//  back until the value matches or the timeout passes, so a poll keeps
+	//  the caller busy for up to its full timeout.
+
+	bool RegisterProgram::Run(const ReadEvent & read, const ReadEvent & poll, const WriteEvent & write,
+		std::vector<Trace> & trace) const
+	{
+		typedef std::chrono::steady_clock Clock;
+		const Clock::duration spin = std::chrono::milliseconds(2);
+		const Clock::time_point t0 = Clock::now();
+
+		trace.clear();
+		trace.reserve(FOps.size());
+		for (size_t i = 0; i < FOps.size(); i++)
+		{
+			const Op & op = FOps[i];
+			Clock::time_point start = Clock::now();
+			Trace t;
+			t.Index = i;
+			t.Value = 0;
+			t.Ok = true;
+
+			switch (op.Code)
+			{
+			case opWrite:
+				write(op.Base, op.Offset, op.Value);
+				t.Value = op.Value;
+				break;
+			case opModify:
+				t.Value = (read(op.Base, op.Offset) & ~op.Mask) | (op.Value & op.Mask);
+				write(op.Base, op.Offset, t.Value);
+				break;
+			case opPoll:
+			{
+				Clock::time_point deadline = start +
+					std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(op.Time));
+				for (;;)
+				{
+					t.Value = poll(op.Base, op.Offset);
+					if ((t.Value & op.Mask) == op.Value)
+						break;
+					if (Clock::now() >= deadline)
+					{
+						t.Ok = false;
+						break;
+					}
+				}
+				break;
+			}
+			case opDelay:
+			{
+				Clock::time_point deadline = start +
+					std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(op.Time));
+				if (deadline - start > spin)
+					std::this_thread::sleep_for(deadline - start - spin);
+				while (Clock::now() < deadline)
+					;
+				break;
+			}
+			}
+
+			Clock::time_point stop = Clock::now();
+			t.Start = std::chrono::duration<double>(start - t0).count();
+			t.Duration = std::chrono::duration<double>(stop - start).count();
+			trace.push_back(t);
+			if (!t.Ok)
+				return false;
+		}
+		return true;
+	}
+
+} // namespace Innovative
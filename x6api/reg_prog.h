@@ -0,0 +1,77 @@
+// This is the header file for wishbone register programs of x6_1000m api
+
+// reg_prog.h
+
+#ifndef reg_progH
+#define reg_progH
+
+#include <stdint.h>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS RegisterProgram -- Register sequence parsed once, run at bus speed
+	//==============================================================================
+	//  One instruction per line, numbers in C notation, '#' starts a comment:
+	//      w  base offset value                    write
+	//      m  base offset mask value               read-modify-write masked bits
+	//      p  base offset mask value timeout_us    poll until (reg & mask) == value
+	//      d  delay_us                             delay
+	//  Operands are unsigned; base, offset, mask and value must fit 32 bits,
+	//  anything else is a parse error rather than a truncated value. A poll that times out stops the program. Polls read through their own
+	//  event, which must reach the bus: the bits polled change in hardware.
+
+	class RegisterProgram
+	{
+	public:
+		typedef std::function<uint32_t(uint32_t, uint32_t)>         ReadEvent;     // base, offset
+		typedef std::function<void(uint32_t, uint32_t, uint32_t)>   WriteEvent;    // base, offset, value
+
+		enum OpCode { opWrite, opModify, opPoll, opDelay };
+
+		struct Op
+		{
+			int         Code;
+			uint32_t    Base;
+			uint32_t    Offset;
+			uint32_t    Mask;
+			uint32_t    Value;
+			double      Time;           // delay or poll timeout, seconds
+			int         Line;           // source line, for messages
+		};
+
+		struct Trace
+		{
+			size_t      Index;          // instruction executed
+			double      Start;          // seconds since Run() began
+			double      Duration;
+			uint32_t    Value;          // value written, or last value read
+			bool        Ok;             // false for a timed out poll
+		};
+
+		//  Methods
+		bool    Parse(const std::string & text, std::string & error);
+		bool    Run(const ReadEvent & read, const ReadEvent & poll, const WriteEvent & write,
+		            std::vector<Trace> & trace) const;
+
+		//  Properties
+		const std::vector<Op> & Ops() const {  return FOps;  }
+
+	private:
+		//
+		//  Member Data
+		std::vector<Op>     FOps;
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
@@ -0,0 +1,97 @@
+// This is the cpp file for the wishbone register shadow of x6_1000m api
+
+// reg_shadow.cpp
+
+
+#include "reg_shadow.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS RegisterShadow
+	//==============================================================================
+	//------------------------------------------------------------------------------
+	//  RegisterShadow::Cache() -- Mark a register as a shadowed config register
+	//------------------------------------------------------------------------------
+
+	void RegisterShadow::Cache(uint32_t base, uint32_t offset, bool enable)
+	{
+		if (!enable)
+		{
+			FEntries.erase(Key(base, offset));
+			return;
+		}
+		if (!FEntries.count(Key(base, offset)))
+		{
+			Entry & e = FEntries[Key(base, offset)];
+			e.Value = 0;
+			e.Known = false;
+		}
+	}
+
+	bool RegisterShadow::Cached(uint32_t base, uint32_t offset) const
+	{
+		return FEntries.count(Key(base, offset)) != 0;
+	}
+
+	//------------------------------------------------------------------------------
+	//  RegisterShadow::Write() -- Record a write, false if the bus can be skipped
+	//------------------------------------------------------------------------------
+
+	bool RegisterShadow::Write(uint32_t base, uint32_t offset, uint32_t value)
+	{
+		EntryMap::iterator it = FEntries.find(Key(base, offset));
+		if (it != FEntries.end())
+		{
+			if (it->second.Known && it->second.Value == value)
+			{
+				FStats.Skipped++;
+				return false;
+			}
+			it->second.Value = value;
+			it->second.Known = true;
+		}
+		FStats.Writes++;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  RegisterShadow::Read() -- Serve a read of a known cached register
+	//------------------------------------------------------------------------------
+
+	bool RegisterShadow::Read(uint32_t base, uint32_t offset, uint32_t & value)
+	{
+		EntryMap::const_iterator it = FEntries.find(Key(base, offset));
+		if (it == FEntries.end() || !it->second.Known)
+			return false;
+		value = it->second.Value;
+		FStats.Served++;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  RegisterShadow::Invalidate(), Clear(), ClearStats() --
+	//------------------------------------------------------------------------------
+
+	void RegisterShadow::Invalidate()
+	{
+		for (EntryMap::iterator it = FEntries.begin(); it != FEntries.end(); ++it)
+			it->second.Known = false;
+	}
+
+	void RegisterShadow::Clear()
+	{
+		FEntries.clear();
+	}
+
+	void RegisterShadow::ClearStats()
+	{
+		FStats.Writes = 0;
+		FStats.Skipped = 0;
+		FStats.Served = 0;
+	}
+
+} // namespace Innovative
@@ -0,0 +1,71 @@
+// This is the header file for the wishbone register shadow of x6_1000m api
+
+// reg_shadow.h
+
+#ifndef reg_shadowH
+#define reg_shadowH
+
+#include <stdint.h>
+#include <map>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS RegisterShadow -- Last written value of cached config registers
+	//==============================================================================
+	//  Only registers marked with Cache() are shadowed, since status and
+	//  strobe registers must always reach the bus. A cached register whose
+	//  value is known skips writes of the same value and serves reads. Only
+	//  a write makes a value known: a write-only register reads back junk.
+
+	class RegisterShadow
+	{
+	public:
+		struct Statistics
+		{
+			unsigned long long  Writes;     // writes passed to the bus
+			unsigned long long  Skipped;    // writes that would not change a value
+			unsigned long long  Served;     // reads answered from the shadow
+		};
+
+		RegisterShadow()
+			{  ClearStats();  }
+
+		//  Methods
+		void    Cache(uint32_t base, uint32_t offset, bool enable);
+		bool    Cached(uint32_t base, uint32_t offset) const;
+		bool    Write(uint32_t base, uint32_t offset, uint32_t value);   // false to skip the bus
+		bool    Read(uint32_t base, uint32_t offset, uint32_t & value);  // true if served
+		void    Invalidate();       // hardware state unknown, e.g. after a reset
+		void    Clear();            // forget which registers are cached
+		void    ClearStats();
+
+		//  Properties
+		const Statistics & Stats() const {  return FStats;  }
+
+	private:
+		struct Entry
+		{
+			uint32_t    Value;
+			bool        Known;      // Value matches the hardware
+		};
+		typedef std::map<uint64_t, Entry> EntryMap;
+
+		//
+		//  Member Data
+		EntryMap        FEntries;
+		Statistics      FStats;
+
+		static uint64_t Key(uint32_t base, uint32_t offset)
+			{  return (static_cast<uint64_t>(base) << 32) | offset;  }
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
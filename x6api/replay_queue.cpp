@@ -0,0 +1,154 @@
+// This is the cpp file for the pattern replay command queue of x6_1000m api
+
+// replay_queue.cpp
+
+
+#include "replay_queue.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS ReplayQueue
+	//==============================================================================
+
+	ReplayQueue::ReplayQueue()
+		: FCommands(std::make_shared<std::vector<Command> >()),
+		FPosted(0), FServed(0), FStopping(false)
+	{
+	}
+
+	ReplayQueue::~ReplayQueue()
+	{
+		Stop();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Program() -- Replace the commands sent for each request
+	//------------------------------------------------------------------------------
+	//  A request already being served finishes with the previous list.
+
+	ReplayQueue::CommandList ReplayQueue::Program(const std::vector<Command> & commands)
+	{
+		CommandList list = std::make_shared<std::vector<Command> >(commands);
+		std::lock_guard<std::mutex> lock(FLock);
+		FCommands = list;
+		return list;
+	}
+
+	ReplayQueue::CommandList ReplayQueue::Commands() const
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		return FCommands;
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Post() -- Request one replay, safe on the trigger edge path
+	//------------------------------------------------------------------------------
+
+	void ReplayQueue::Post()
+	{
+		{
+			std::lock_guard<std::mutex> lock(FLock);
+			FPosted++;
+		}
+		FWake.notify_one();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Start() -- Launch the worker, requests posted before are dropped
+	//------------------------------------------------------------------------------
+
+	bool ReplayQueue::Start()
+	{
+		if (Running())
+		{
+			bool halted;
+			{
+				std::lock_guard<std::mutex> lock(FLock);
+				halted = FStopping;
+			}
+			if (!halted)
+				return true;
+			FThread.join();
+		}
+		if (!FSend)
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(FLock);
+			FServed = FPosted;
+			FStopping = false;
+		}
+		FThread = std::thread(&ReplayQueue::Execute, this);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Stop() -- Finish the current request and join the worker
+	//------------------------------------------------------------------------------
+
+	void ReplayQueue::Stop()
+	{
+		if (!FThread.joinable() || FThread.get_id() == std::this_thread::get_id())
+			return;
+		Halt();
+		FThread.join();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Halt() -- Let the worker stop after the current request
+	//------------------------------------------------------------------------------
+	//  Returns at once. The worker may be blocked sending on the very stream
+	//  whose callback calls this; Stop() or Start() joins it later.
+
+	void ReplayQueue::Halt()
+	{
+		{
+			std::lock_guard<std::mutex> lock(FLock);
+			FStopping = true;
+		}
+		FWake.notify_one();
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Posted(), Served() --
+	//------------------------------------------------------------------------------
+
+	unsigned long long ReplayQueue::Posted() const
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		return FPosted;
+	}
+
+	unsigned long long ReplayQueue::Served() const
+	{
+		std::lock_guard<std::mutex> lock(FLock);
+		return FServed;
+	}
+
+	//------------------------------------------------------------------------------
+	//  ReplayQueue::Execute() -- Worker thread body
+	//------------------------------------------------------------------------------
+
+	void ReplayQueue::Execute()
+	{
+		std::unique_lock<std::mutex> lock(FLock);
+		for (;;)
+		{
+			FWake.wait(lock, [this] {  return FStopping || FServed != FPosted;  });
+			if (FStopping)
+				break;
+
+			CommandList list = FCommands;
+			FServed++;
+			lock.unlock();
+			for (size_t i = 0; i < list->size(); i++)
+				FSend((*list)[i]);
+			lock.lock();
+		}
+	}
+
+} // namespace Innovative
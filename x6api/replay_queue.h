@@ -0,0 +1,80 @@
+// This is the header file for the pattern replay command queue of x6_1000m api
+
+// replay_queue.h
+
+#ifndef replay_queueH
+#define replay_queueH
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS ReplayQueue -- Replay info packets posted from a worker thread
+	//==============================================================================
+	//  The replay commands are prepared once by Program(). A trigger edge only
+	//  calls Post(), which counts the request and wakes the worker; the worker
+	//  sends every programmed command once per request, in order.
+
+	class ReplayQueue
+	{
+	public:
+		struct Command
+		{
+			std::vector<unsigned int>  Sids;
+			std::vector<char>          Tags;
+			unsigned int               Addr;
+			unsigned int               SizeInWords;
+			unsigned int               RepCount;
+			int                        Mode;        // IPatternModeSystem::PatternRepeatType
+		};
+
+		typedef std::shared_ptr<const std::vector<Command> >  CommandList;
+		typedef std::function<void(const Command &)>          SendEvent;
+
+		ReplayQueue();
+		~ReplayQueue();
+
+		//  Properties
+		void    OnSend(const SendEvent & send) {  FSend = send;  }
+		bool    Running() const {  return FThread.joinable();  }
+		unsigned long long  Posted() const;
+		unsigned long long  Served() const;
+
+		//  Methods
+		CommandList  Program(const std::vector<Command> & commands);
+		CommandList  Commands() const;
+		void    Post();
+		bool    Start();
+		void    Stop();         // requests not yet served are dropped
+		void    Halt();         // Stop() without the join, for callbacks on the send path
+
+	private:
+		//
+		//  Member Data
+		SendEvent                   FSend;
+		CommandList                 FCommands;
+		unsigned long long          FPosted;
+		unsigned long long          FServed;
+		bool                        FStopping;
+		mutable std::mutex          FLock;
+		std::condition_variable     FWake;
+		std::thread                 FThread;
+
+		void    Execute();
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
@@ -0,0 +1,140 @@
+// This is the header file for the lock-free record ring of x6_1000m api
+
+// seq_ring.h
+
+#ifndef seq_ringH
+#define seq_ringH
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS SeqRing -- Bounded ring of sequence-stamped records
+	//==============================================================================
+	//  Push() is wait-free and safe from any thread: it claims the next sequence
+	//  number and stamps the slot odd while copying the record, even once it is
+	//  complete. Readers copy slots without locking and tell apart a slot still
+	//  being written (stamp behind) from one overwritten by a later wrap (stamp
+	//  ahead); only the second counts as lost.
+
+	template <class T>
+	class SeqRing
+	{
+	public:
+		explicit SeqRing(unsigned int capacity)
+			: FCapacity(capacity ? capacity : 1), FSlots(new Slot[capacity ? capacity : 1]),
+			FHead(0), FStart(0)
+		{
+			for (unsigned int i = 0; i < FCapacity; i++)
+				FSlots[i].Seq = 0;
+		}
+
+		//  Properties
+		unsigned int        Capacity() const {  return FCapacity;  }
+		unsigned long long  Count() const {  return FHead.load() - FStart.load();  }
+
+		//  Methods
+
+		//  Start a new window; records pushed before stay out of Snapshot()
+		void Reset()
+		{
+			FStart = FHead.load();
+		}
+
+		void Push(const T & rec)
+		{
+			unsigned long long seq = FHead.fetch_add(1);
+			Slot & slot = FSlots[seq % FCapacity];
+			slot.Seq.store(Stamp(seq) - 1, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_release);
+			slot.Rec = rec;
+			slot.Seq.store(Stamp(seq), std::memory_order_release);
+		}
+
+		//  Most recent complete record of the window, false if none
+		bool Latest(T & rec) const
+		{
+			unsigned long long start = FStart.load();
+			unsigned long long head = FHead.load(std::memory_order_acquire);
+			unsigned long long first = Window(start, head);
+			for (unsigned long long seq = head; seq > first; seq--)
+				if (Read(seq - 1, rec) == rsOk)
+					return true;
+			return false;
+		}
+
+		//  Complete records of the window, oldest first. Returns the records
+		//  lost to wraps; slots still being written are skipped, not counted.
+		size_t Snapshot(std::vector<T> & records) const
+		{
+			records.clear();
+			unsigned long long start = FStart.load();
+			unsigned long long head = FHead.load(std::memory_order_acquire);
+			unsigned long long first = Window(start, head);
+			size_t dropped = static_cast<size_t>(first - start);
+
+			records.reserve(static_cast<size_t>(head - first));
+			for (unsigned long long seq = first; seq < head; seq++)
+			{
+				T rec;
+				switch (Read(seq, rec))
+				{
+				case rsOk:          records.push_back(rec);  break;
+				case rsOverwritten: dropped++;  break;
+				default:            break;
+				}
+			}
+			return dropped;
+		}
+
+	private:
+		enum ReadState { rsOk, rsPending, rsOverwritten };
+
+		struct Slot
+		{
+			std::atomic<unsigned long long>  Seq;
+			T                                Rec;
+		};
+
+		//
+		//  Member Data
+		unsigned int                        FCapacity;
+		std::unique_ptr<Slot[]>             FSlots;
+		std::atomic<unsigned long long>     FHead;
+		std::atomic<unsigned long long>     FStart;     // FHead at Reset()
+
+		static unsigned long long Stamp(unsigned long long seq) {  return 2 * (seq + 1);  }
+
+		//  First sequence of the window still held by the ring
+		unsigned long long Window(unsigned long long start, unsigned long long head) const
+		{
+			return (head - start > FCapacity) ? head - FCapacity : start;
+		}
+
+		ReadState Read(unsigned long long seq, T & rec) const
+		{
+			const Slot & slot = FSlots[seq % FCapacity];
+			unsigned long long stamp = slot.Seq.load(std::memory_order_acquire);
+			if (stamp != Stamp(seq))
+				return (stamp > Stamp(seq)) ? rsOverwritten : rsPending;
+			rec = slot.Rec;
+			std::atomic_thread_fence(std::memory_order_acquire);
+			stamp = slot.Seq.load(std::memory_order_relaxed);
+			if (stamp != Stamp(seq))
+				return (stamp > Stamp(seq)) ? rsOverwritten : rsPending;
+			return rsOk;
+		}
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
@@ -0,0 +1,128 @@
+// This is the cpp file for binary settings profiles of x6_1000m api
+
+// settings_io.cpp
+
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include "settings_io.h"
+
+using namespace std;
+
+namespace Innovative
+{
+	static const char kMagic[4] = { 'X', '6', 'S', 'P' };
+
+	//------------------------------------------------------------------------
+	// ProfileHash() -- 64-bit FNV-1a of the payload
+	//------------------------------------------------------------------------
+
+	uint64_t ProfileHash(const char * data, size_t size)
+	{
+		uint64_t hash = 14695981039346656037ULL;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= static_cast<unsigned char>(data[i]);
+			hash *= 1099511628211ULL;
+		}
+		return hash;
+	}
+
+	//==============================================================================
+	//  CLASS SettingsWriter
+	//==============================================================================
+	//------------------------------------------------------------------------------
+	//  SettingsWriter::Hash() -- Content hash of the fields written so far
+	//------------------------------------------------------------------------------
+
+	uint64_t SettingsWriter::Hash() const
+	{
+		return ProfileHash(FPayload.empty() ? 0 : &FPayload[0], FPayload.size());
+	}
+
+	//------------------------------------------------------------------------------
+	//  SettingsWriter::Save() -- Write the profile, false if the file fails
+	//------------------------------------------------------------------------------
+
+	bool SettingsWriter::Save(const std::string & path, uint32_t version) const
+	{
+		std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+		if (!file)
+			return false;
+		uint64_t hash = Hash();
+		uint32_t size = static_cast<uint32_t>(FPayload.size());
+		file.write(kMagic, sizeof(kMagic));
+		file.write(reinterpret_cast<const char *>(&version), sizeof(version));
+		file.write(reinterpret_cast<const char *>(&hash), sizeof(hash));
+		file.write(reinterpret_cast<const char *>(&size), sizeof(size));
+		if (size)
+			file.write(&FPayload[0], size);
+		return static_cast<bool>(file);
+	}
+
+	//==============================================================================
+	//  CLASS SettingsReader
+	//==============================================================================
+	//------------------------------------------------------------------------------
+	//  SettingsReader::Load() -- Read and verify a profile before any field is read
+	//------------------------------------------------------------------------------
+
+	bool SettingsReader::Load(const std::string & path, uint32_t version, std::string & error)
+	{
+		std::ifstream file(path.c_str(), std::ios::binary);
+		if (!file)
+		{
+			error = "cannot open " + path;
+			return false;
+		}
+		char magic[4];
+		uint32_t file_version = 0;
+		uint64_t hash = 0;
+		uint32_t size = 0;
+		file.read(magic, sizeof(magic));
+		file.read(reinterpret_cast<char *>(&file_version), sizeof(file_version));
+		file.read(reinterpret_cast<char *>(&hash), sizeof(hash));
+		file.read(reinterpret_cast<char *>(&size), sizeof(size));
+		if (!file || !std::equal(magic, magic + 4, kMagic))
+		{
+			error = path + " is not a settings profile";
+			return false;
+		}
+		if (file_version != version)
+		{
+			std::ostringstream msg;
+			msg << path << " is version " << file_version << ", expected " << version;
+			error = msg.str();
+			return false;
+		}
+		FPayload.resize(size);
+		if (size)
+			file.read(&FPayload[0], size);
+		if (!file || ProfileHash(size ? &FPayload[0] : 0, size) != hash)
+		{
+			error = path + " is truncated or corrupt";
+			return false;
+		}
+		FPos = 0;
+		FFailed = false;
+		FHash = hash;
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  SettingsReader::Take() -- Consume bytes, failing past the payload end
+	//------------------------------------------------------------------------------
+
+	bool SettingsReader::Take(size_t bytes)
+	{
+		if (FFailed || bytes > FPayload.size() - FPos)
+		{
+			FFailed = true;
+			return false;
+		}
+		FPos += bytes;
+		return true;
+	}
+
+} // namespace Innovative
@@ -0,0 +1,129 @@
+// This is the header file for binary settings profiles of x6_1000m api
+
+// settings_io.h
+
+#ifndef settings_ioH
+#define settings_ioH
+
+#include <stdint.h>
+#include <array>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS SettingsWriter -- Serializes fields into a hashed profile
+	//==============================================================================
+	//  Fields are written in call order with no names or padding, so a reader
+	//  must visit the same fields in the same order. File layout:
+	//      magic "X6SP", version, payload hash, payload size, payload
+
+	class SettingsWriter
+	{
+	public:
+		template <typename T>
+		void operator()(const T & value)
+		{
+			const char * p = reinterpret_cast<const char *>(&value);
+			FPayload.insert(FPayload.end(), p, p + sizeof(T));
+		}
+		template <typename T, size_t N>
+		void operator()(const std::array<T, N> & values)
+		{
+			for (size_t i = 0; i < N; i++)
+				(*this)(values[i]);
+		}
+		template <typename T>
+		void operator()(const std::vector<T> & values)
+		{
+			(*this)(static_cast<uint32_t>(values.size()));
+			for (size_t i = 0; i < values.size(); i++)
+				(*this)(values[i]);
+		}
+		void operator()(const std::string & value)
+		{
+			(*this)(static_cast<uint32_t>(value.size()));
+			FPayload.insert(FPayload.end(), value.begin(), value.end());
+		}
+
+		uint64_t    Hash() const;
+		bool        Save(const std::string & path, uint32_t version) const;
+
+	private:
+		std::vector<char>   FPayload;
+	};
+
+	//==============================================================================
+	//  CLASS SettingsReader -- Reads fields back from a verified profile
+	//==============================================================================
+
+	class SettingsReader
+	{
+	public:
+		SettingsReader()
+			: FPos(0), FFailed(false), FHash(0)
+			{}
+
+		template <typename T>
+		void operator()(T & value)
+		{
+			if (!Take(sizeof(T)))
+				return;
+			std::memcpy(&value, &FPayload[FPos - sizeof(T)], sizeof(T));   // payload is unaligned
+		}
+		template <typename T, size_t N>
+		void operator()(std::array<T, N> & values)
+		{
+			for (size_t i = 0; i < N; i++)
+				(*this)(values[i]);
+		}
+		template <typename T>
+		void operator()(std::vector<T> & values)
+		{
+			uint32_t size = 0;
+			(*this)(size);
+			if (FFailed || size > FPayload.size() - FPos)
+			{
+				FFailed = true;
+				return;
+			}
+			values.resize(size);
+			for (size_t i = 0; i < values.size(); i++)
+				(*this)(values[i]);
+		}
+		void operator()(std::string & value)
+		{
+			uint32_t size = 0;
+			(*this)(size);
+			if (!Take(size))
+				return;
+			value.assign(&FPayload[FPos - size], size);
+		}
+
+		bool        Load(const std::string & path, uint32_t version, std::string & error);
+		//  true once every field was read and the payload is used up
+		bool        Complete() const {  return !FFailed && FPos == FPayload.size();  }
+		uint64_t    Hash() const {  return FHash;  }
+
+	private:
+		std::vector<char>   FPayload;
+		size_t              FPos;
+		bool                FFailed;
+		uint64_t            FHash;
+
+		bool    Take(size_t bytes);
+	};
+
+	uint64_t    ProfileHash(const char * data, size_t size);
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
@@ -0,0 +1,326 @@
+// This is the cpp file for the software trigger scheduler of x6_1000m api
+
+// trig_sched.cpp
+
+
+#include <cmath>
+#include <algorithm>
+#include "trig_sched.h"
+
+using namespace std;
+
+namespace Innovative
+{
+
+	//==============================================================================
+	//  CLASS TriggerLog
+	//==============================================================================
+
+	TriggerLog::TriggerLog(unsigned int capacity)
+		: FRing(capacity), FEpoch(0)
+	{
+		Reset();
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::Reset() -- Start a new run, timestamps count from now
+	//------------------------------------------------------------------------------
+	//  Slots are not cleared; Snapshot() only reads records pushed from here on.
+
+	void TriggerLog::Reset()
+	{
+		FEpoch = Clock::now().time_since_epoch().count();
+		FRing.Reset();
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::Push() -- Timestamp an edge, optionally against a deadline
+	//------------------------------------------------------------------------------
+
+	void TriggerLog::Push(int source)
+	{
+		Store(source, Clock::now(), 0., false);
+	}
+
+	void TriggerLog::Push(int source, Clock::time_point deadline)
+	{
+		Clock::time_point now = Clock::now();
+		Store(source, now, std::chrono::duration<double>(now - deadline).count(), true);
+	}
+
+	void TriggerLog::Store(int source, Clock::time_point now, double lateness, bool scheduled)
+	{
+		Record rec;
+		Clock::duration since = now.time_since_epoch() - Clock::duration(FEpoch.load());
+		rec.Time = std::chrono::duration<double>(since).count();
+		rec.Lateness = lateness;
+		rec.Scheduled = scheduled;
+		rec.Source = source;
+		FRing.Push(rec);
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::Snapshot() -- Copy out the records of the current run
+	//------------------------------------------------------------------------------
+
+	size_t TriggerLog::Snapshot(std::vector<Record> & records) const
+	{
+		return FRing.Snapshot(records);
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::TriggerEdges() -- Manual trigger edges, in time order
+	//------------------------------------------------------------------------------
+	//  Software triggers would count as short periods, so they are left out.
+
+	void TriggerLog::TriggerEdges(std::vector<Record> & edges) const
+	{
+		std::vector<Record> records;
+		Snapshot(records);
+
+		edges.clear();
+		for (size_t i = 0; i < records.size(); i++)
+			if (records[i].Source == esManualLow)
+				edges.push_back(records[i]);
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::PeriodHistogram() -- Count edge intervals in bins of bin s
+	//------------------------------------------------------------------------------
+	//  The last bin also collects every longer interval.
+
+	void TriggerLog::PeriodHistogram(double bin, unsigned int bins, std::vector<int> & counts) const
+	{
+		counts.assign(bins, 0);
+		if (!bins || bin <= 0.)
+			return;
+
+		std::vector<Record> edges;
+		TriggerEdges(edges);
+		for (size_t i = 1; i < edges.size(); i++)
+		{
+			double dt = edges[i].Time - edges[i - 1].Time;
+			size_t b = (dt > 0.) ? static_cast<size_t>(dt / bin) : 0;
+			counts[(std::min)(b, static_cast<size_t>(bins - 1))]++;
+		}
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::LatenessPercentiles() -- Lateness at each percent (0..100)
+	//------------------------------------------------------------------------------
+
+	void TriggerLog::LatenessPercentiles(const std::vector<double> & percents, std::vector<double> & result) const
+	{
+		std::vector<Record> edges;
+		TriggerEdges(edges);
+
+		std::vector<double> late;
+		for (size_t i = 0; i < edges.size(); i++)
+			if (edges[i].Scheduled)
+				late.push_back(edges[i].Lateness);
+		std::sort(late.begin(), late.end());
+
+		result.clear();
+		for (size_t i = 0; i < percents.size(); i++)
+		{
+			if (late.empty())
+			{
+				result.push_back(0.);
+				continue;
+			}
+			double p = (std::min)((std::max)(percents[i], 0.), 100.);
+			size_t k = static_cast<size_t>(p / 100. * (late.size() - 1) + 0.5);
+			result.push_back(late[k]);
+		}
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerLog::MissedDeadlines() -- Scheduled edges later than limit seconds
+	//------------------------------------------------------------------------------
+
+	unsigned int TriggerLog::MissedDeadlines(double limit) const
+	{
+		std::vector<Record> edges;
+		TriggerEdges(edges);
+
+		unsigned int missed = 0;
+		for (size_t i = 0; i < edges.size(); i++)
+			if (edges[i].Scheduled && edges[i].Lateness > limit)
+				missed++;
+		return missed;
+	}
+
+	//==============================================================================
+	//  CLASS TriggerScheduler
+	//==============================================================================
+
+	TriggerScheduler::TriggerScheduler()
+		: FPeriod(1e-3), FSpin(2e-3), FCount(0), FRunning(false), FStop(false)
+	{
+		FStats = Statistics();
+	}
+
+	TriggerScheduler::~TriggerScheduler()
+	{
+		Stop();
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Start() -- Launch a train of count triggers
+	//------------------------------------------------------------------------------
+
+	bool TriggerScheduler::Start(unsigned int count)
+	{
+		Stop();
+		if (!FEdge || FPeriod <= 0.)
+			return false;
+
+		{
+			std::lock_guard<std::mutex> lock(FStatsLock);
+			FStats = Statistics();
+			FError.clear();
+		}
+		FCount = count;
+		FStop = false;
+		FRunning = true;
+		FThread = std::thread(&TriggerScheduler::Execute, this);
+		return true;
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Stop() -- Abort the train after the current trigger
+	//------------------------------------------------------------------------------
+
+	void TriggerScheduler::Stop()
+	{
+		FStop = true;
+		Wait();
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Wait() -- Block until the train has finished
+	//------------------------------------------------------------------------------
+
+	void TriggerScheduler::Wait()
+	{
+		if (FThread.joinable() && FThread.get_id() != std::this_thread::get_id())
+			FThread.join();
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Stats() -- Achieved timing of the current/last train
+	//------------------------------------------------------------------------------
+
+	TriggerScheduler::Statistics TriggerScheduler::Stats() const
+	{
+		std::lock_guard<std::mutex> lock(FStatsLock);
+		return FStats;
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Error() -- Why the current/last train stopped early
+	//------------------------------------------------------------------------------
+
+	std::string TriggerScheduler::Error() const
+	{
+		std::lock_guard<std::mutex> lock(FStatsLock);
+		return FError;
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::WaitUntil() -- Hybrid sleep/spin wait for a deadline
+	//------------------------------------------------------------------------------
+
+	void TriggerScheduler::WaitUntil(Clock::time_point deadline)
+	{
+		const Clock::duration spin =
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FSpin));
+
+		Clock::time_point now = Clock::now();
+		if (deadline - now > spin)
+			std::this_thread::sleep_for(deadline - now - spin);
+
+		while (Clock::now() < deadline && !FStop)
+			std::this_thread::yield();
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Execute() -- Scheduler thread body
+	//------------------------------------------------------------------------------
+	//  Deadlines are absolute so errors do not accumulate. When an edge runs a
+	//  whole period late the schedule is rebased instead of bursting to catch up.
+
+	void TriggerScheduler::Execute()
+	{
+		try
+		{
+			Run();
+		}
+		catch (const std::exception & e)
+		{
+			std::lock_guard<std::mutex> lock(FStatsLock);
+			FError = e.what();
+		}
+		catch (...)
+		{
+			std::lock_guard<std::mutex> lock(FStatsLock);
+			FError = "unknown exception";
+		}
+		FRunning = false;
+	}
+
+	//------------------------------------------------------------------------------
+	//  TriggerScheduler::Run() -- Issue the edges of one train
+	//------------------------------------------------------------------------------
+
+	void TriggerScheduler::Run()
+	{
+		const Clock::duration period =
+			std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FPeriod));
+		const Clock::duration half = period / 2;
+
+		double sum = 0., sum_sq = 0.;
+		Clock::time_point deadline = Clock::now() + period;
+		Clock::time_point last;
+
+		for (unsigned int k = 0; (!FCount || k < FCount) && !FStop; ++k)
+		{
+			WaitUntil(deadline);
+			if (FStop)
+				break;
+			Clock::time_point edge = Clock::now();
+			FEdge(false, deadline);
+
+			double late = std::chrono::duration<double>(edge - deadline).count();
+			{
+				std::lock_guard<std::mutex> lock(FStatsLock);
+				Statistics & st = FStats;
+				st.MaxLateness = (std::max)(st.MaxLateness, late);
+				if (st.Triggers)
+				{
+					double dt = std::chrono::duration<double>(edge - last).count();
+					double err = dt - FPeriod;
+					unsigned int n = st.Triggers;
+					sum += dt;
+					sum_sq += err*err;
+					st.MinPeriod = (n == 1) ? dt : (std::min)(st.MinPeriod, dt);
+					st.MaxPeriod = (std::max)(st.MaxPeriod, dt);
+					st.MeanPeriod = sum / n;
+					st.Jitter = std::sqrt(sum_sq / n);
+				}
+				st.Triggers++;
+				if (late > FPeriod)
+					st.Overruns++;
+			}
+			last = edge;
+
+			WaitUntil(deadline + half);
+			FEdge(true, deadline + half);
+
+			deadline += period;
+			if (Clock::now() > deadline + period)
+				deadline = Clock::now() + period;
+		}
+	}
+
+} // namespace Innovative
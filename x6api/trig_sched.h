@@ -0,0 +1,137 @@
+// This is the header file for the software trigger scheduler of x6_1000m api
+
+// trig_sched.h
+
+#ifndef trig_schedH
+#define trig_schedH
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "seq_ring.h"
+
+namespace Innovative
+{
+#ifdef __CLR_VER
+#pragma managed(push, off)
+#endif
+	//==============================================================================
+	//  CLASS TriggerLog -- Lock-free ring of trigger edge timestamps
+	//==============================================================================
+	//  Any thread may Push(); records go to a SeqRing, so Snapshot() never
+	//  locks and skips slots that are still being written.
+
+	class TriggerLog
+	{
+	public:
+		typedef std::chrono::steady_clock  Clock;
+
+		enum EdgeSource { esManualLow, esManualHigh, esSoftware };
+
+		struct Record
+		{
+			double      Time;           // seconds since Reset()
+			double      Lateness;       // seconds past the scheduled deadline
+			bool        Scheduled;      // Lateness is valid
+			int         Source;         // EdgeSource
+		};
+
+		explicit TriggerLog(unsigned int capacity = 0x10000);
+
+		//  Methods
+		void    Reset();
+		void    Push(int source);
+		void    Push(int source, Clock::time_point deadline);
+		size_t  Snapshot(std::vector<Record> & records) const;   // returns records lost
+
+		//  Analysis of the manual trigger (falling) edges since Reset();
+		//  software triggers are logged but fire off any schedule
+		void    PeriodHistogram(double bin, unsigned int bins, std::vector<int> & counts) const;
+		void    LatenessPercentiles(const std::vector<double> & percents, std::vector<double> & result) const;
+		unsigned int  MissedDeadlines(double limit) const;
+
+	private:
+		//
+		//  Member Data
+		SeqRing<Record>                     FRing;
+		std::atomic<long long>              FEpoch;     // Clock ticks at Reset()
+
+		void    Store(int source, Clock::time_point now, double lateness, bool scheduled);
+		void    TriggerEdges(std::vector<Record> & edges) const;
+	};
+
+	//==============================================================================
+	//  CLASS TriggerScheduler -- Periodic manual trigger train on its own thread
+	//==============================================================================
+	//  Each trigger is a falling edge at t0 + k*Period followed by a rising edge
+	//  half a period later. Waits longer than SpinThreshold sleep until
+	//  SpinThreshold before the deadline; the rest, and any shorter wait, is
+	//  spent yielding on the monotonic clock. SpinThreshold should cover the
+	//  OS sleep granularity, so the period is not bound to it. An exception
+	//  from the edge event stops the train; Error() then holds its message.
+
+	class TriggerScheduler
+	{
+	public:
+		typedef std::chrono::steady_clock  Clock;
+		typedef std::function<void(bool, Clock::time_point)>  EdgeEvent;   // state, deadline
+
+		struct Statistics
+		{
+			unsigned int    Triggers;       // falling edges issued
+			unsigned int    Overruns;       // deadlines missed by a whole period
+			double          MeanPeriod;     // seconds, between falling edges
+			double          MinPeriod;
+			double          MaxPeriod;
+			double          Jitter;         // RMS deviation from Period, seconds
+			double          MaxLateness;    // worst edge delay past its deadline
+		};
+
+		TriggerScheduler();
+		~TriggerScheduler();
+
+		//  Properties
+		void    OnEdge(const EdgeEvent & edge) {  FEdge = edge;  }
+		void    Period(double seconds) {  FPeriod = seconds;  }
+		double  Period() const {  return FPeriod;  }
+		void    SpinThreshold(double seconds) {  FSpin = seconds;  }
+		double  SpinThreshold() const {  return FSpin;  }
+		bool    Running() const {  return FRunning;  }
+		Statistics  Stats() const;
+		std::string  Error() const;         // empty unless an edge event threw
+
+		//  Methods
+		bool    Start(unsigned int count);   // count 0 runs until Stop()
+		void    Stop();
+		void    Wait();
+
+	private:
+		//
+		//  Member Data
+		EdgeEvent            FEdge;
+		double               FPeriod;
+		double               FSpin;
+		unsigned int         FCount;
+		std::atomic<bool>    FRunning;
+		std::atomic<bool>    FStop;
+		std::thread          FThread;
+		mutable std::mutex   FStatsLock;
+		Statistics           FStats;
+		std::string          FError;
+
+		void    Execute();
+		void    Run();
+		void    WaitUntil(Clock::time_point deadline);
+	};
+
+#ifdef __CLR_VER
+#pragma managed(pop)
+#endif
+} // namespace Innovative
+
+#endif
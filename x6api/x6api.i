@@ -1,13 +1,67 @@
 // author: LiuQichun
 // date: 2020-03-27
 
-%module x6api
+%module(threads="1") x6api
+// Every call releases the GIL while in C++, whatever the swig command line;
+// these block for long and must never lose it
+%threadallow X6api::Open;
+%threadallow X6api::open_warm;
+%threadallow X6api::Close;
+%threadallow X6api::~X6api;
+%threadallow X6api::StartStreaming;
+%threadallow X6api::StreamPreconfigure;
+%threadallow X6api::PatternLoadCommand;
+%threadallow X6api::SequenceLoadCommand;
+%threadallow X6api::do_trigger;
+%threadallow X6api::wait_trigger_train;
+%threadallow X6api::wait_pattern_done;
+%threadallow X6api::wait_pattern_count;
+%threadallow X6api::wait_pattern_load;
+%threadallow X6api::pattern_load_result;
+%threadallow X6api::ReadRom;
+%threadallow X6api::WriteRom;
+%threadallow X6api::stop_health_monitor;
+%threadallow X6api::run_register_program;
+%include stdint.i
+%include std_string.i
 %include std_vector.i
 namespace std {
     %template(IntVector) vector<int>;
     %template(DoubleVector) vector<double>;
 };
 %{
+#define SWIG_FILE_WITH_INIT
 #include "X6api.h"
 %}
+// numpy.i ships with numpy, under tools/swig
+%include "numpy.i"
+%init %{
+import_array();
+%}
+// ADC capture becomes a (repeats, channels, samples) numpy array owning the
+// C++ buffer; the capture is moved out, so read_adc_data() is empty afterwards
+%apply (short ** ARGOUTVIEWM_ARRAY3, int * DIM1, int * DIM2, int * DIM3) { (short ** data, int * repeats, int * channels, int * samples) };
+// DAC waveform read straight from the caller's array
+%apply (double * IN_ARRAY1, int DIM1) { (const double * wave, int length) };
+%apply (float * IN_ARRAY1, int DIM1) { (const float * wave, int length) };
+%apply (short * IN_ARRAY1, int DIM1) { (const short * codes, int length) };
+// wishbone batches as (N, 3) / (N, 2) uint32 arrays, readback as a numpy array
+%apply (unsigned int * IN_ARRAY2, int DIM1, int DIM2) { (const uint32_t * ops, int rows, int cols) };
+%apply (unsigned int * IN_ARRAY2, int DIM1, int DIM2) { (const uint32_t * addrs, int rows, int cols) };
+%apply (unsigned int ** ARGOUTVIEWM_ARRAY1, int * DIM1) { (uint32_t ** values, int * count) };
+// write_dac_wavedata() below takes numpy arrays and falls back for sequences
+%rename(write_dac_vector) X6api::write_dac_wavedata;
 %include "X6api.h"
+%extend X6api {
+%pythoncode %{
+def write_dac_wavedata(self, wavedata):
+    """Arrays and sequences; int16 arrays are DAC codes, sent unquantized"""
+    import numpy
+    wave = numpy.asarray(wavedata)
+    if wave.dtype == numpy.int16:
+        return self.write_dac_codes(wave.ravel())
+    if wave.dtype == numpy.float32:
+        return self.write_dac_array_f32(wave.ravel())
+    return self.write_dac_array(wave.ravel())
+%}
+}